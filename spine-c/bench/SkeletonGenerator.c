@@ -0,0 +1,578 @@
+#include "SkeletonGenerator.h"
+#include <spine/Attachment.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Values SkeletonBinary.c expects for timeline and curve types. */
+enum {
+	TIMELINE_SCALE, TIMELINE_ROTATE, TIMELINE_TRANSLATE, TIMELINE_ATTACHMENT, TIMELINE_COLOR, TIMELINE_FLIPX, TIMELINE_FLIPY
+};
+enum {
+	CURVE_LINEAR, CURVE_STEPPED, CURVE_BEZIER
+};
+
+#define FPS 30.0f
+
+typedef struct {
+	unsigned char* data;
+	size_t length, capacity;
+	int /*bool*/ failed;
+} _Writer;
+
+typedef struct {
+	spSkeletonGeneratorParams params;
+	_Writer writer;
+	char name[64];
+} _Generator;
+
+/**/
+
+static void writeByte (_Writer* self, int value) {
+	if (self->length == self->capacity) {
+		size_t capacity = self->capacity ? self->capacity * 2 : 64 * 1024;
+		unsigned char* data;
+		if (self->failed) return;
+		data = (unsigned char*)realloc(self->data, capacity);
+		if (!data) {
+			self->failed = 1;
+			return;
+		}
+		self->data = data;
+		self->capacity = capacity;
+	}
+	self->data[self->length++] = (unsigned char)value;
+}
+
+static void writeBoolean (_Writer* self, int value) {
+	writeByte(self, value ? 1 : 0);
+}
+
+static void writeInt (_Writer* self, unsigned int value) {
+	writeByte(self, (int)(value >> 24));
+	writeByte(self, (int)(value >> 16));
+	writeByte(self, (int)(value >> 8));
+	writeByte(self, (int)value);
+}
+
+static void writeVarint (_Writer* self, int value, int /*bool*/ optimizePositive) {
+	unsigned int bits = optimizePositive ? (unsigned int)value : ((unsigned int)value << 1) ^ (unsigned int)(value >> 31);
+	while (bits > 0x7F) {
+		writeByte(self, (int)((bits & 0x7F) | 0x80));
+		bits >>= 7;
+	}
+	writeByte(self, (int)bits);
+}
+
+static void writeFloat (_Writer* self, float value) {
+	union {
+		unsigned int intValue;
+		float floatValue;
+	} intToFloat;
+	intToFloat.floatValue = value;
+	writeInt(self, intToFloat.intValue);
+}
+
+static void writeString (_Writer* self, const char* value) {
+	if (!value) {
+		writeVarint(self, 0, 1);
+		return;
+	}
+	writeVarint(self, (int)strlen(value) + 1, 1);
+	while (*value) writeByte(self, *value++);
+}
+
+static void writeColor (_Writer* self, unsigned int rgba) {
+	writeInt(self, rgba);
+}
+
+/* Cycles through linear, stepped and bezier curves. */
+static void writeCurve (_Writer* self, int frameIndex) {
+	switch (frameIndex % 3) {
+	case 0:
+		writeByte(self, CURVE_LINEAR);
+		break;
+	case 1:
+		writeByte(self, CURVE_STEPPED);
+		break;
+	default:
+		writeByte(self, CURVE_BEZIER);
+		writeFloat(self, 0.25f);
+		writeFloat(self, 0.1f);
+		writeFloat(self, 0.75f);
+		writeFloat(self, 0.9f);
+	}
+}
+
+/**/
+
+static const char* formatName (_Generator* self, const char* prefix, int index) {
+	sprintf(self->name, "%s%d", prefix, index);
+	return self->name;
+}
+
+static int isMeshSlot (const spSkeletonGeneratorParams* params, int slotIndex) {
+	return params->meshVertices > 0 && slotIndex % 2 == 0;
+}
+
+/* Floats of an FFD key for the mesh, which are per weight for skinned meshes. */
+static int getDeformLength (const spSkeletonGeneratorParams* params) {
+	return params->meshVertices * 2 * (params->bonesPerVertex ? params->bonesPerVertex : 1);
+}
+
+static int getFfdSlotsCount (const spSkeletonGeneratorParams* params) {
+	int meshSlots = params->meshVertices > 0 ? (params->slotsCount + 1) / 2 : 0;
+	return params->ffdTimelines < meshSlots ? params->ffdTimelines : meshSlots;
+}
+
+static void writeRegion (_Generator* self, int regionIndex) {
+	_Writer* writer = &self->writer;
+	writeByte(writer, SP_ATTACHMENT_REGION);
+	writeString(writer, formatName(self, "region", regionIndex));
+	writeFloat(writer, 2); /* x */
+	writeFloat(writer, -3); /* y */
+	writeFloat(writer, 1); /* scaleX */
+	writeFloat(writer, 1); /* scaleY */
+	writeFloat(writer, (float)(regionIndex % 4 * 90)); /* rotation */
+	writeFloat(writer, 32); /* width */
+	writeFloat(writer, 32); /* height */
+	writeColor(writer, 0xFFFFFFFF);
+}
+
+/* A fan of triangles over vertices laid out on a circle. */
+static void writeMesh (_Generator* self, int slotIndex, int regionIndex) {
+	const spSkeletonGeneratorParams* params = &self->params;
+	_Writer* writer = &self->writer;
+	int vertices = params->meshVertices, i, ii;
+
+	writeByte(writer, params->bonesPerVertex ? SP_ATTACHMENT_SKINNED_MESH : SP_ATTACHMENT_MESH);
+	writeString(writer, formatName(self, "region", regionIndex));
+
+	writeVarint(writer, vertices * 2, 1);
+	for (i = 0; i < vertices * 2; ++i)
+		writeFloat(writer, (float)((i * 7) % 11) / 10.0f);
+
+	writeVarint(writer, (vertices - 2) * 3, 1);
+	for (i = 1; i < vertices - 1; ++i) {
+		int triangle[3];
+		triangle[0] = 0;
+		triangle[1] = i;
+		triangle[2] = i + 1;
+		for (ii = 0; ii < 3; ++ii) {
+			writeByte(writer, triangle[ii] >> 8);
+			writeByte(writer, triangle[ii]);
+		}
+	}
+
+	if (!params->bonesPerVertex) {
+		writeVarint(writer, vertices * 2, 1);
+		for (i = 0; i < vertices; ++i) {
+			writeFloat(writer, (float)(i % 13) * 4);
+			writeFloat(writer, (float)(i % 7) * 4);
+		}
+	} else {
+		/* Each vertex is the bone count followed by bone index, x, y and weight per bone, all written as floats. */
+		int bonesPerVertex = params->bonesPerVertex;
+		writeVarint(writer, vertices * (1 + bonesPerVertex * 4), 1);
+		for (i = 0; i < vertices; ++i) {
+			writeFloat(writer, (float)bonesPerVertex);
+			for (ii = 0; ii < bonesPerVertex; ++ii) {
+				writeFloat(writer, (float)((slotIndex + i + ii) % params->bonesCount));
+				writeFloat(writer, (float)(i % 13) * 4);
+				writeFloat(writer, (float)(i % 7) * 4);
+				writeFloat(writer, 1.0f / bonesPerVertex);
+			}
+		}
+	}
+
+	writeColor(writer, 0xFFFFFFFF);
+	writeVarint(writer, vertices, 1); /* Hull. */
+
+	if (params->nonessential) {
+		writeVarint(writer, vertices * 2, 1);
+		for (i = 0; i < vertices; ++i) {
+			writeVarint(writer, i * 2, 1);
+			writeVarint(writer, (i + 1) % vertices * 2, 1);
+		}
+		writeFloat(writer, 64);
+		writeFloat(writer, 64);
+	}
+}
+
+static void writeBoundingBox (_Generator* self) {
+	_Writer* writer = &self->writer;
+	writeByte(writer, SP_ATTACHMENT_BOUNDING_BOX);
+	writeVarint(writer, 8, 1);
+	writeFloat(writer, -16);
+	writeFloat(writer, -16);
+	writeFloat(writer, 16);
+	writeFloat(writer, -16);
+	writeFloat(writer, 16);
+	writeFloat(writer, 16);
+	writeFloat(writer, -16);
+	writeFloat(writer, 16);
+}
+
+/* Every skin has an attachment under the same name for every slot, so skins can be swapped. Skin 0 is the default skin. */
+static void writeSkin (_Generator* self, int skinIndex) {
+	const spSkeletonGeneratorParams* params = &self->params;
+	_Writer* writer = &self->writer;
+	int i;
+
+	writeVarint(writer, params->slotsCount, 1);
+	for (i = 0; i < params->slotsCount; ++i) {
+		int regionIndex = (i + skinIndex) % params->regionsCount;
+		int boundingBox = params->boundingBoxes && i % 8 == 7;
+		writeVarint(writer, i, 1);
+		writeVarint(writer, boundingBox ? 2 : 1, 1);
+
+		writeString(writer, formatName(self, "attachment", i));
+		writeString(writer, 0); /* Same as the key. */
+		if (isMeshSlot(params, i))
+			writeMesh(self, i, regionIndex);
+		else
+			writeRegion(self, regionIndex);
+
+		if (boundingBox) {
+			writeString(writer, formatName(self, "bounds", i));
+			writeString(writer, 0);
+			writeBoundingBox(self);
+		}
+	}
+}
+
+static void writeAnimation (_Generator* self, int animationIndex) {
+	const spSkeletonGeneratorParams* params = &self->params;
+	_Writer* writer = &self->writer;
+	int frames = params->framesCount;
+	int slotTimelines = params->slotTimelines < params->slotsCount ? params->slotTimelines : params->slotsCount;
+	int boneTimelines = params->boneTimelines < params->bonesCount ? params->boneTimelines : params->bonesCount;
+	int ffdSlots = getFfdSlotsCount(params);
+	int i, ii, frame;
+
+	writeString(writer, formatName(self, "animation", animationIndex));
+
+	/* Slot timelines. */
+	writeVarint(writer, slotTimelines, 1);
+	for (i = 0; i < slotTimelines; ++i) {
+		writeVarint(writer, i, 1);
+		writeVarint(writer, 2, 1);
+
+		writeByte(writer, TIMELINE_COLOR);
+		writeVarint(writer, frames, 1);
+		for (frame = 0; frame < frames; ++frame) {
+			writeFloat(writer, frame / FPS);
+			writeColor(writer, frame % 2 ? 0xFFFFFFFF : 0x8080FFC0);
+			if (frame < frames - 1) writeCurve(writer, frame);
+		}
+
+		writeByte(writer, TIMELINE_ATTACHMENT);
+		writeVarint(writer, frames, 1);
+		for (frame = 0; frame < frames; ++frame) {
+			writeFloat(writer, frame / FPS);
+			writeString(writer, frame % 2 ? 0 : formatName(self, "attachment", i));
+		}
+	}
+
+	/* Bone timelines. */
+	writeVarint(writer, boneTimelines, 1);
+	for (i = 0; i < boneTimelines; ++i) {
+		writeVarint(writer, i, 1);
+		writeVarint(writer, i == 0 ? 5 : 3, 1);
+
+		writeByte(writer, TIMELINE_ROTATE);
+		writeVarint(writer, frames, 1);
+		for (frame = 0; frame < frames; ++frame) {
+			writeFloat(writer, frame / FPS);
+			writeFloat(writer, (float)((frame + animationIndex) * 15 % 360));
+			if (frame < frames - 1) writeCurve(writer, frame);
+		}
+
+		for (ii = 0; ii < 2; ++ii) {
+			writeByte(writer, ii == 0 ? TIMELINE_TRANSLATE : TIMELINE_SCALE);
+			writeVarint(writer, frames, 1);
+			for (frame = 0; frame < frames; ++frame) {
+				writeFloat(writer, frame / FPS);
+				writeFloat(writer, ii == 0 ? (float)frame : 1 + frame * 0.01f);
+				writeFloat(writer, ii == 0 ? (float)-frame : 1 - frame * 0.01f);
+				if (frame < frames - 1) writeCurve(writer, frame);
+			}
+		}
+
+		if (i == 0) {
+			for (ii = 0; ii < 2; ++ii) {
+				writeByte(writer, ii == 0 ? TIMELINE_FLIPX : TIMELINE_FLIPY);
+				writeVarint(writer, frames, 1);
+				for (frame = 0; frame < frames; ++frame) {
+					writeFloat(writer, frame / FPS);
+					writeBoolean(writer, frame % 2);
+				}
+			}
+		}
+	}
+
+	/* IK constraint timelines. */
+	writeVarint(writer, params->ikConstraintsCount, 1);
+	for (i = 0; i < params->ikConstraintsCount; ++i) {
+		writeVarint(writer, i, 1);
+		writeVarint(writer, frames, 1);
+		for (frame = 0; frame < frames; ++frame) {
+			writeFloat(writer, frame / FPS);
+			writeFloat(writer, frame % 2 ? 1.0f : 0.5f);
+			writeByte(writer, frame % 2 ? 1 : -1);
+			if (frame < frames - 1) writeCurve(writer, frame);
+		}
+	}
+
+	/* FFD timelines of the default skin. Keys alternate between the setup pose and a range of offsets. */
+	writeVarint(writer, ffdSlots ? 1 : 0, 1);
+	if (ffdSlots) {
+		int deformLength = getDeformLength(params);
+		writeVarint(writer, 0, 1);
+		writeVarint(writer, ffdSlots, 1);
+		for (i = 0; i < ffdSlots; ++i) {
+			writeVarint(writer, i * 2, 1);
+			writeVarint(writer, 1, 1);
+			writeString(writer, formatName(self, "attachment", i * 2));
+			writeVarint(writer, frames, 1);
+			for (frame = 0; frame < frames; ++frame) {
+				writeFloat(writer, frame / FPS);
+				if (frame % 2 == 0)
+					writeVarint(writer, 0, 1);
+				else {
+					int start = frame % 4 * 2 % deformLength;
+					int end = deformLength - start > deformLength / 2 ? deformLength / 2 : deformLength - start;
+					if (end < 1) end = 1;
+					writeVarint(writer, end, 1);
+					writeVarint(writer, start, 1);
+					for (ii = 0; ii < end; ++ii)
+						writeFloat(writer, (float)((ii + frame) % 5) - 2);
+				}
+				if (frame < frames - 1) writeCurve(writer, frame);
+			}
+		}
+	}
+
+	/* Draw order. Every fourth key is the setup order, others move every other slot one place up. */
+	writeVarint(writer, params->drawOrderFrames, 1);
+	for (frame = 0; frame < params->drawOrderFrames; ++frame) {
+		int offsets = params->slotsCount / 2;
+		if (params->drawOrderOffsets < offsets) offsets = params->drawOrderOffsets;
+		if (frame % 4 == 3) offsets = 0;
+		writeVarint(writer, offsets, 1);
+		for (i = 0; i < offsets; ++i) {
+			writeVarint(writer, i * 2, 1);
+			writeVarint(writer, 1, 1);
+		}
+		writeFloat(writer, frame / FPS);
+	}
+
+	/* Events, spread over the animation. Odd events override the default string. */
+	writeVarint(writer, params->eventsCount, 1);
+	for (i = 0; i < params->eventsCount; ++i) {
+		writeFloat(writer, (frames - 1) / FPS * i / params->eventsCount);
+		writeVarint(writer, i, 1);
+		writeVarint(writer, i - animationIndex, 0);
+		writeFloat(writer, i * 0.5f);
+		writeBoolean(writer, i % 2);
+		if (i % 2) writeString(writer, formatName(self, "override", animationIndex));
+	}
+}
+
+static void writeSkeleton (_Generator* self) {
+	const spSkeletonGeneratorParams* params = &self->params;
+	_Writer* writer = &self->writer;
+	int i;
+
+	writeString(writer, "generated");
+	writeString(writer, "2.1.27");
+	writeFloat(writer, 256);
+	writeFloat(writer, 256);
+	writeBoolean(writer, params->nonessential);
+	if (params->nonessential) writeString(writer, "./images/");
+
+	writeVarint(writer, params->bonesCount, 1);
+	for (i = 0; i < params->bonesCount; ++i) {
+		writeString(writer, formatName(self, "bone", i));
+		writeVarint(writer, i == 0 ? 0 : (i - 1) / params->boneBranching + 1, 1); /* Parent index + 1. */
+		writeFloat(writer, i == 0 ? 0 : 10); /* x */
+		writeFloat(writer, i == 0 ? 0 : (float)(i % 3)); /* y */
+		writeFloat(writer, 1); /* scaleX */
+		writeFloat(writer, 1); /* scaleY */
+		writeFloat(writer, (float)(i % 8 * 5)); /* rotation */
+		writeFloat(writer, 10); /* length */
+		writeBoolean(writer, 0); /* flipX */
+		writeBoolean(writer, 0); /* flipY */
+		writeBoolean(writer, i % 5 != 4); /* inheritScale */
+		writeBoolean(writer, i % 7 != 6); /* inheritRotation */
+		if (params->nonessential) writeColor(writer, 0x9B9B9BFF);
+	}
+
+	/* Each IK constraint bends one bone toward the root. */
+	writeVarint(writer, params->ikConstraintsCount, 1);
+	for (i = 0; i < params->ikConstraintsCount; ++i) {
+		writeString(writer, formatName(self, "ik", i));
+		writeVarint(writer, 1, 1);
+		writeVarint(writer, 1 + i % (params->bonesCount - 1), 1);
+		writeVarint(writer, 0, 1);
+		writeFloat(writer, 1);
+		writeByte(writer, i % 2 ? 1 : -1);
+	}
+
+	writeVarint(writer, params->slotsCount, 1);
+	for (i = 0; i < params->slotsCount; ++i) {
+		writeString(writer, formatName(self, "slot", i));
+		writeVarint(writer, i % params->bonesCount, 1);
+		writeColor(writer, 0xFFFFFFFF);
+		writeString(writer, formatName(self, "attachment", i));
+		writeBoolean(writer, i % 16 == 15);
+	}
+
+	writeSkin(self, 0);
+	writeVarint(writer, params->skinsCount, 1);
+	for (i = 1; i <= params->skinsCount; ++i) {
+		writeString(writer, formatName(self, "skin", i));
+		writeSkin(self, i);
+	}
+
+	writeVarint(writer, params->eventsCount, 1);
+	for (i = 0; i < params->eventsCount; ++i) {
+		writeString(writer, formatName(self, "event", i));
+		writeVarint(writer, i - params->eventsCount / 2, 0);
+		writeFloat(writer, i * 0.25f);
+		writeString(writer, i % 2 ? 0 : "payload");
+	}
+
+	writeVarint(writer, params->animationsCount, 1);
+	for (i = 0; i < params->animationsCount; ++i)
+		writeAnimation(self, i);
+}
+
+/* Keeps the counts within what the format and the generated references allow. */
+static void clampParams (spSkeletonGeneratorParams* params) {
+	if (params->bonesCount < 1) params->bonesCount = 1;
+	if (params->boneBranching < 1) params->boneBranching = 1;
+	if (params->bonesCount < 2 || params->ikConstraintsCount < 0) params->ikConstraintsCount = 0;
+	if (params->slotsCount < 1) params->slotsCount = 1;
+	if (params->skinsCount < 0) params->skinsCount = 0;
+	if (params->meshVertices < 0) params->meshVertices = 0;
+	if (params->meshVertices > 0 && params->meshVertices < 3) params->meshVertices = 3;
+	if (params->meshVertices > 65535) params->meshVertices = 65535;
+	if (params->bonesPerVertex < 0) params->bonesPerVertex = 0;
+	if (params->regionsCount < 1) params->regionsCount = 1;
+	if (params->animationsCount < 0) params->animationsCount = 0;
+	if (params->framesCount < 1) params->framesCount = 1;
+	if (params->boneTimelines < 0) params->boneTimelines = 0;
+	if (params->slotTimelines < 0) params->slotTimelines = 0;
+	if (params->ffdTimelines < 0) params->ffdTimelines = 0;
+	if (params->drawOrderFrames < 0) params->drawOrderFrames = 0;
+	if (params->drawOrderOffsets < 0) params->drawOrderOffsets = 0;
+	if (params->eventsCount < 0) params->eventsCount = 0;
+}
+
+/**/
+
+int spSkeletonGeneratorParams_setPreset (spSkeletonGeneratorParams* self, const char* name) {
+	memset(self, 0, sizeof(spSkeletonGeneratorParams));
+	self->regionsCount = 16;
+	if (strcmp(name, "small") == 0) {
+		self->bonesCount = 16;
+		self->boneBranching = 2;
+		self->ikConstraintsCount = 1;
+		self->slotsCount = 8;
+		self->animationsCount = 4;
+		self->framesCount = 10;
+		self->boneTimelines = 8;
+		self->slotTimelines = 4;
+		self->eventsCount = 2;
+	} else if (strcmp(name, "medium") == 0) {
+		self->bonesCount = 100;
+		self->boneBranching = 3;
+		self->ikConstraintsCount = 4;
+		self->slotsCount = 60;
+		self->skinsCount = 2;
+		self->meshVertices = 32;
+		self->bonesPerVertex = 2;
+		self->boundingBoxes = 1;
+		self->animationsCount = 40;
+		self->framesCount = 30;
+		self->boneTimelines = 50;
+		self->slotTimelines = 8;
+		self->ffdTimelines = 4;
+		self->drawOrderFrames = 10;
+		self->drawOrderOffsets = 8;
+		self->eventsCount = 4;
+		self->nonessential = 1;
+	} else if (strcmp(name, "large") == 0) {
+		self->bonesCount = 300;
+		self->boneBranching = 3;
+		self->ikConstraintsCount = 8;
+		self->slotsCount = 200;
+		self->skinsCount = 4;
+		self->meshVertices = 64;
+		self->bonesPerVertex = 4;
+		self->boundingBoxes = 1;
+		self->regionsCount = 64;
+		self->animationsCount = 100;
+		self->framesCount = 30;
+		self->boneTimelines = 100;
+		self->slotTimelines = 16;
+		self->ffdTimelines = 8;
+		self->drawOrderFrames = 20;
+		self->drawOrderOffsets = 16;
+		self->eventsCount = 8;
+		self->nonessential = 1;
+	} else if (strcmp(name, "huge") == 0) {
+		self->bonesCount = 1000;
+		self->boneBranching = 4;
+		self->ikConstraintsCount = 16;
+		self->slotsCount = 500;
+		self->skinsCount = 8;
+		self->meshVertices = 64;
+		self->bonesPerVertex = 4;
+		self->boundingBoxes = 1;
+		self->regionsCount = 256;
+		self->animationsCount = 200;
+		self->framesCount = 30;
+		self->boneTimelines = 200;
+		self->slotTimelines = 32;
+		self->ffdTimelines = 16;
+		self->drawOrderFrames = 30;
+		self->drawOrderOffsets = 32;
+		self->eventsCount = 16;
+		self->nonessential = 1;
+	} else
+		return 0;
+	return 1;
+}
+
+unsigned char* spSkeletonGenerator_write (const spSkeletonGeneratorParams* params, int* length) {
+	_Generator generator;
+	memset(&generator, 0, sizeof(_Generator));
+	generator.params = *params;
+	clampParams(&generator.params);
+
+	writeSkeleton(&generator);
+	if (generator.writer.failed || generator.writer.length > 0x7FFFFFFF) {
+		free(generator.writer.data);
+		*length = 0;
+		return 0;
+	}
+	*length = (int)generator.writer.length;
+	return generator.writer.data;
+}
+
+char* spSkeletonGenerator_writeAtlas (const spSkeletonGeneratorParams* params, const char* imageName, int* length) {
+	static const char* regionFormat =
+			"region%d\n  rotate: false\n  xy: %d, %d\n  size: 32, 32\n  orig: 32, 32\n  offset: 0, 0\n  index: -1\n";
+	int regionsCount = params->regionsCount < 1 ? 1 : params->regionsCount;
+	int columns = 32, size = 32 * columns, i;
+	char* atlas = (char*)malloc(strlen(imageName) + 128 + (size_t)regionsCount * 128);
+	if (!atlas) return 0;
+
+	*length = sprintf(atlas, "\n%s\nsize: %d, %d\nformat: RGBA8888\nfilter: Linear,Linear\nrepeat: none\n", imageName, size,
+			(regionsCount + columns - 1) / columns * 32);
+	for (i = 0; i < regionsCount; ++i)
+		*length += sprintf(atlas + *length, regionFormat, i, i % columns * 32, i / columns * 32);
+	return atlas;
+}
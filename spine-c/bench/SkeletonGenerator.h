@@ -0,0 +1,56 @@
+#ifndef SPINE_SKELETONGENERATOR_H_
+#define SPINE_SKELETONGENERATOR_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Writes synthetic skeletons in the 2.1 binary format read by SkeletonBinary.c, together with an atlas naming every region
+ * the attachments use. Sizes are set by the parameters, so files from a few KB to hundreds of MB can be made to measure
+ * loading without real assets. Output is deterministic for the same parameters.
+ */
+typedef struct spSkeletonGeneratorParams {
+	int bonesCount;
+	int boneBranching; /* Children per bone. 1 makes a chain, bonesCount makes every bone a child of the root. */
+	int ikConstraintsCount;
+	int slotsCount;
+	int skinsCount; /* Skins besides the default skin, each with an attachment for every slot. */
+	int meshVertices; /* Vertices of the mesh on every other slot. 0 uses region attachments only. */
+	int bonesPerVertex; /* Weights per mesh vertex. 0 writes plain meshes, otherwise skinned meshes. */
+	int boundingBoxes; /* Adds a bounding box attachment to every eighth slot. */
+	int regionsCount;
+
+	int animationsCount;
+	int framesCount; /* Keys of every timeline. */
+	int boneTimelines; /* Bones keyed with rotate, translate and scale in each animation. The root also gets flips. */
+	int slotTimelines; /* Slots keyed with color and attachment in each animation. */
+	int ffdTimelines; /* Meshes of the default skin keyed with FFD in each animation. */
+	int drawOrderFrames;
+	int drawOrderOffsets; /* Slots moved by each draw order key. */
+	int eventsCount; /* Event definitions, each keyed once per animation. */
+
+	int /*bool*/ nonessential;
+} spSkeletonGeneratorParams;
+
+/* Sets the parameters of a named preset: "small", "medium", "large" or "huge". Returns 0 if the name is unknown. */
+int spSkeletonGeneratorParams_setPreset (spSkeletonGeneratorParams* self, const char* name);
+
+/* Returns the encoded skeleton, to be released with free(), or 0 if out of memory. */
+unsigned char* spSkeletonGenerator_write (const spSkeletonGeneratorParams* params, int* length);
+
+/* Returns atlas text in the format read by spAtlas_create, to be released with free(). */
+char* spSkeletonGenerator_writeAtlas (const spSkeletonGeneratorParams* params, const char* imageName, int* length);
+
+#ifdef SPINE_SHORT_NAMES
+typedef spSkeletonGeneratorParams SkeletonGeneratorParams;
+#define SkeletonGeneratorParams_setPreset(...) spSkeletonGeneratorParams_setPreset(__VA_ARGS__)
+#define SkeletonGenerator_write(...) spSkeletonGenerator_write(__VA_ARGS__)
+#define SkeletonGenerator_writeAtlas(...) spSkeletonGenerator_writeAtlas(__VA_ARGS__)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SPINE_SKELETONGENERATOR_H_ */
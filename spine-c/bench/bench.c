@@ -0,0 +1,720 @@
+/*
+ * Microbenchmarks for the binary reader and the runtime's hot paths.
+ *
+ * Build it from a spine-c 2.1.25 tree with this repository's files copied over, for example:
+ *   cc -O2 -Ispine-c/include -o spine-bench spine-c/bench/bench.c spine-c/bench/SkeletonGenerator.c spine-c/src/spine/[a-zA-Z]*.c -lm -lpthread
+ *   ./spine-bench > bench_output.txt
+ *
+ * Options:
+ *   --pool           Install spPoolAllocator before running.
+ *   --filter TEXT    Only run benchmarks whose name contains TEXT.
+ *   --samples N      Timed samples per benchmark, the median is reported. Default 5.
+ *   --min-ms N       Minimum duration of a sample in milliseconds. Default 100.
+ *
+ * Output is tab separated with one line per benchmark, lines starting with # are comments:
+ *   benchmark  iterations  ns_per_op  bytes_per_op  allocations_per_op
+ * Bytes and allocations count every MALLOC, CALLOC and REALLOC made during one operation.
+ */
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L /* clock_gettime */
+#endif
+
+#include <spine/spine.h>
+#include <spine/extension.h>
+#include <spine/Array.h>
+#include <spine/PoolAllocator.h>
+#include <spine/SkeletonBake.h>
+#include <spine/Skinning.h>
+#include <spine/VertexPipeline.h>
+#include "SkeletonGenerator.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+static double nowNs () {
+#if defined(_WIN32)
+	LARGE_INTEGER frequency, counter;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&counter);
+	return (double)counter.QuadPart * 1e9 / (double)frequency.QuadPart;
+#else
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (double)time.tv_sec * 1e9 + (double)time.tv_nsec;
+#endif
+}
+
+/**/
+
+/* Counting hooks, forwarding to the system allocator or the pool. */
+
+static void* (*baseMalloc) (size_t size) = malloc;
+static void* (*baseRealloc) (void* ptr, size_t size) = realloc;
+static void (*baseFree) (void* ptr) = free;
+static size_t allocatedBytes, allocationsCount;
+
+static void* countingMalloc (size_t size) {
+	allocatedBytes += size;
+	allocationsCount++;
+	return baseMalloc(size);
+}
+
+static void* countingRealloc (void* ptr, size_t size) {
+	allocatedBytes += size;
+	allocationsCount++;
+	return baseRealloc(ptr, size);
+}
+
+static void countingFree (void* ptr) {
+	baseFree(ptr);
+}
+
+/**/
+
+static spAtlas* createAtlas (const spSkeletonGeneratorParams* params) {
+	int length;
+	char* text = spSkeletonGenerator_writeAtlas(params, "bench.png", &length);
+	spAtlas* atlas = spAtlas_create(text, length, "", 0);
+	free(text);
+	return atlas;
+}
+
+/**/
+
+typedef struct {
+	const char* name;
+	void (*setup) (void* state);
+	void (*run) (void* state);
+	void (*teardown) (void* state);
+	void* state;
+} Benchmark;
+
+/* Loading from memory. */
+
+typedef struct {
+	spSkeletonGeneratorParams params;
+	unsigned char* skeleton;
+	int length;
+	spAtlas* atlas;
+} LoadState;
+
+static void loadSetup (void* state) {
+	LoadState* self = (LoadState*)state;
+	self->skeleton = spSkeletonGenerator_write(&self->params, &self->length);
+	printf("# skeleton bytes\t%d\n", self->length);
+	self->atlas = createAtlas(&self->params);
+}
+
+static void loadRun (void* state) {
+	LoadState* self = (LoadState*)state;
+	spSkeletonBinary* binary = spSkeletonBinary_create(self->atlas);
+	spSkeletonData* skeletonData = spSkeletonBinary_readSkeletonData(binary, self->skeleton, self->length);
+	if (!skeletonData) {
+		fprintf(stderr, "Unable to read the generated skeleton: %s\n", binary->error);
+		exit(1);
+	}
+	spSkeletonData_dispose(skeletonData);
+	spSkeletonBinary_dispose(binary);
+}
+
+static void loadTeardown (void* state) {
+	LoadState* self = (LoadState*)state;
+	spAtlas_dispose(self->atlas);
+	free(self->skeleton);
+}
+
+/* Loading with an attachment loader which finds regions by spAtlas_findRegion's scan, as the 2.1.25 loader does, to compare
+ * with the indexed AtlasAttachmentLoader. Only regions and bounding boxes are created. */
+
+typedef struct {
+	spAttachmentLoader super;
+	spAtlas* atlas;
+} ScanLoader;
+
+static void scanLoaderDispose (spAttachmentLoader* loader) {
+	_spAttachmentLoader_deinit(loader);
+}
+
+static spAttachment* scanLoaderNewAttachment (spAttachmentLoader* loader, spSkin* skin, spAttachmentType type,
+		const char* name, const char* path) {
+	ScanLoader* self = SUB_CAST(ScanLoader, loader);
+	spRegionAttachment* attachment;
+	spAtlasRegion* region;
+	UNUSED(skin);
+	if (type == SP_ATTACHMENT_BOUNDING_BOX) return SUPER(spBoundingBoxAttachment_create(name));
+	if (type != SP_ATTACHMENT_REGION) {
+		_spAttachmentLoader_setUnknownTypeError(loader, type);
+		return 0;
+	}
+	region = spAtlas_findRegion(self->atlas, path);
+	if (!region) {
+		_spAttachmentLoader_setError(loader, "Region not found: ", path);
+		return 0;
+	}
+	attachment = spRegionAttachment_create(name);
+	attachment->rendererObject = region;
+	spRegionAttachment_setUVs(attachment, region->u, region->v, region->u2, region->v2, region->rotate);
+	attachment->regionOffsetX = region->offsetX;
+	attachment->regionOffsetY = region->offsetY;
+	attachment->regionWidth = region->width;
+	attachment->regionHeight = region->height;
+	attachment->regionOriginalWidth = region->originalWidth;
+	attachment->regionOriginalHeight = region->originalHeight;
+	return SUPER(attachment);
+}
+
+static void loadScanRun (void* state) {
+	LoadState* self = (LoadState*)state;
+	ScanLoader* loader = NEW(ScanLoader);
+	spSkeletonBinary* binary;
+	spSkeletonData* skeletonData;
+	_spAttachmentLoader_init(SUPER(loader), scanLoaderDispose, scanLoaderNewAttachment);
+	loader->atlas = self->atlas;
+	binary = spSkeletonBinary_createWithLoader(SUPER(loader));
+	skeletonData = spSkeletonBinary_readSkeletonData(binary, self->skeleton, self->length);
+	if (!skeletonData) {
+		fprintf(stderr, "Unable to read the generated skeleton: %s\n", binary->error);
+		exit(1);
+	}
+	spSkeletonData_dispose(skeletonData);
+	spSkeletonBinary_dispose(binary);
+	spAttachmentLoader_dispose(SUPER(loader));
+}
+
+/* Loading a baked image of the same skeletons from memory, and writing it. */
+
+typedef struct {
+	LoadState load;
+	spSkeletonBinary* binary;
+	spSkeletonData* skeletonData;
+	unsigned char* image;
+	int length;
+} BakeState;
+
+static void bakeSetup (void* state) {
+	BakeState* self = (BakeState*)state;
+	loadSetup(&self->load);
+	self->binary = spSkeletonBinary_create(self->load.atlas);
+	self->skeletonData = spSkeletonBinary_readSkeletonData(self->binary, self->load.skeleton, self->load.length);
+	if (!self->skeletonData) {
+		fprintf(stderr, "Unable to read the generated skeleton: %s\n", self->binary->error);
+		exit(1);
+	}
+	self->image = spSkeletonBake_write(self->skeletonData, &self->length);
+	printf("# baked bytes\t%d\n", self->length);
+}
+
+static void bakeWriteRun (void* state) {
+	BakeState* self = (BakeState*)state;
+	int length;
+	unsigned char* image = spSkeletonBake_write(self->skeletonData, &length);
+	FREE(image);
+}
+
+static void bakeRun (void* state) {
+	BakeState* self = (BakeState*)state;
+	spSkeletonBinary* binary = spSkeletonBinary_create(self->load.atlas);
+	spSkeletonData* skeletonData = spSkeletonBake_read(binary, self->image, self->length);
+	if (!skeletonData) {
+		fprintf(stderr, "Unable to read the baked skeleton: %s\n", binary->error);
+		exit(1);
+	}
+	spSkeletonData_dispose(skeletonData);
+	spSkeletonBinary_dispose(binary);
+}
+
+static void bakeTeardown (void* state) {
+	BakeState* self = (BakeState*)state;
+	FREE(self->image);
+	spSkeletonData_dispose(self->skeletonData);
+	spSkeletonBinary_dispose(self->binary);
+	loadTeardown(&self->load);
+}
+
+/* The reader's varint and float array decoders over encoded data, without the rest of a load. */
+
+#define DECODE_VALUES 4096
+#define DECODE_FLOATS 20000
+
+typedef struct {
+	unsigned char* data;
+	int* values;
+} DecodeState;
+
+static unsigned char* writeVarint (unsigned char* cursor, unsigned int value) {
+	for (; value >= 0x80; value >>= 7)
+		*cursor++ = (unsigned char)(value | 0x80);
+	*cursor++ = (unsigned char)value;
+	return cursor;
+}
+
+/* Values of 1 to 4 bytes in turn. */
+static int varintValue (int index) {
+	return (int)(((unsigned int)index * 2654435761u) >> (25 - index % 4 * 7));
+}
+
+static void readVarintSetup (void* state) {
+	DecodeState* self = (DecodeState*)state;
+	unsigned char* cursor;
+	int i;
+	self->data = cursor = (unsigned char*)malloc(DECODE_VALUES * 5);
+	self->values = (int*)malloc(sizeof(int) * DECODE_VALUES);
+	for (i = 0; i < DECODE_VALUES; ++i)
+		cursor = writeVarint(cursor, (unsigned int)varintValue(i));
+	_spSkeletonBinary_readVarints(self->data, DECODE_VALUES, 1, self->values);
+	for (i = 0; i < DECODE_VALUES; ++i) {
+		if (self->values[i] == varintValue(i)) continue;
+		fprintf(stderr, "read_varint: value %d is %d, expected %d.\n", i, self->values[i], varintValue(i));
+		exit(1);
+	}
+}
+
+static void readVarintRun (void* state) {
+	DecodeState* self = (DecodeState*)state;
+	_spSkeletonBinary_readVarints(self->data, DECODE_VALUES, 1, self->values);
+}
+
+/* A varint size, then big endian floats. */
+static void readFloatArraySetup (void* state) {
+	DecodeState* self = (DecodeState*)state;
+	unsigned char* cursor;
+	int i;
+	self->data = cursor = (unsigned char*)malloc(5 + DECODE_FLOATS * 4);
+	self->values = 0;
+	cursor = writeVarint(cursor, DECODE_FLOATS);
+	for (i = 0; i < DECODE_FLOATS; ++i) {
+		union {
+			float floatValue;
+			unsigned int intValue;
+		} value;
+		value.floatValue = (float)i * 0.25f - 1000;
+		*cursor++ = (unsigned char)(value.intValue >> 24);
+		*cursor++ = (unsigned char)(value.intValue >> 16);
+		*cursor++ = (unsigned char)(value.intValue >> 8);
+		*cursor++ = (unsigned char)value.intValue;
+	}
+}
+
+static void readFloatArrayRun (void* state) {
+	DecodeState* self = (DecodeState*)state;
+	float* values;
+	int size;
+	_spSkeletonBinary_readFloatArray(self->data, 1, &values, &size);
+	FREE(values);
+}
+
+static void decodeTeardown (void* state) {
+	DecodeState* self = (DecodeState*)state;
+	free(self->data);
+	free(self->values);
+}
+
+/* spBone_updateWorldTransform over a whole skeleton. */
+
+typedef struct {
+	spSkeletonGeneratorParams params;
+	spAtlas* atlas;
+	spSkeletonData* skeletonData;
+	spSkeleton* skeleton;
+} BonesState;
+
+static void bonesSetup (void* state) {
+	BonesState* self = (BonesState*)state;
+	spSkeletonBinary* binary;
+	int length;
+	unsigned char* skeleton = spSkeletonGenerator_write(&self->params, &length);
+	self->atlas = createAtlas(&self->params);
+	binary = spSkeletonBinary_create(self->atlas);
+	self->skeletonData = spSkeletonBinary_readSkeletonData(binary, skeleton, length);
+	spSkeletonBinary_dispose(binary);
+	free(skeleton);
+	self->skeleton = spSkeleton_create(self->skeletonData);
+}
+
+static void bonesRun (void* state) {
+	BonesState* self = (BonesState*)state;
+	int i;
+	for (i = 0; i < self->skeleton->bonesCount; ++i)
+		spBone_updateWorldTransform(self->skeleton->bones[i]);
+}
+
+static void bonesTeardown (void* state) {
+	BonesState* self = (BonesState*)state;
+	spSkeleton_dispose(self->skeleton);
+	spSkeletonData_dispose(self->skeletonData);
+	spAtlas_dispose(self->atlas);
+}
+
+/* World vertices of one skinned mesh, by the attachment and by spSkinningMesh, alone and for a batch of instances. */
+
+#define SKINNING_INSTANCES 16
+
+typedef struct {
+	BonesState bones;
+	spSkinnedMeshAttachment* attachment;
+	spSkinningPalette* palette;
+	spSkinningMesh* mesh;
+	spSkinningInstance instances[SKINNING_INSTANCES];
+} SkinningState;
+
+static void skinningSetup (void* state) {
+	SkinningState* self = (SkinningState*)state;
+	spSlot* slot;
+	int i;
+	bonesSetup(&self->bones);
+	spSkeleton_updateWorldTransform(self->bones.skeleton);
+	slot = self->bones.skeleton->slots[0];
+	if (!slot->attachment || slot->attachment->type != SP_ATTACHMENT_SKINNED_MESH) {
+		fprintf(stderr, "The generated skeleton has no skinned mesh.\n");
+		exit(1);
+	}
+	self->attachment = SUB_CAST(spSkinnedMeshAttachment, slot->attachment);
+	self->palette = spSkinningPalette_create(self->bones.skeleton->bonesCount);
+	spSkinningPalette_update(self->palette, self->bones.skeleton);
+	self->mesh = spSkinningMesh_create(self->attachment);
+	for (i = 0; i < SKINNING_INSTANCES; ++i) {
+		self->instances[i].palette = self->palette;
+		self->instances[i].x = 0;
+		self->instances[i].y = 0;
+		self->instances[i].ffd = 0;
+		self->instances[i].worldVertices = MALLOC(float, self->mesh->worldVerticesCount);
+	}
+}
+
+static void skinningAttachmentRun (void* state) {
+	SkinningState* self = (SkinningState*)state;
+	spSkinnedMeshAttachment_computeWorldVertices(self->attachment, 0, 0, self->bones.skeleton->slots[0],
+			self->instances[0].worldVertices);
+}
+
+static void skinningMeshRun (void* state) {
+	SkinningState* self = (SkinningState*)state;
+	spSkinningMesh_computeWorldVertices(self->mesh, self->palette, 0, 0, 0, self->instances[0].worldVertices);
+}
+
+static void skinningBatchRun (void* state) {
+	SkinningState* self = (SkinningState*)state;
+	spSkinningMesh_computeBatch(self->mesh, self->instances, SKINNING_INSTANCES);
+}
+
+static void skinningTeardown (void* state) {
+	SkinningState* self = (SkinningState*)state;
+	int i;
+	for (i = 0; i < SKINNING_INSTANCES; ++i)
+		FREE(self->instances[i].worldVertices);
+	spSkinningMesh_dispose(self->mesh);
+	spSkinningPalette_dispose(self->palette);
+	bonesTeardown(&self->bones);
+}
+
+/* World vertices of every attachment of a crowd of skeletons, one attachment after another and by spVertexPipeline. */
+
+#define PIPELINE_SKELETONS 32
+
+typedef struct {
+	BonesState bones;
+	spSkeleton* skeletons[PIPELINE_SKELETONS];
+	spVertexPipeline* pipeline;
+	float* vertices;
+} PipelineState;
+
+static void pipelineSetup (void* state) {
+	PipelineState* self = (PipelineState*)state;
+	int i;
+	bonesSetup(&self->bones);
+	for (i = 0; i < PIPELINE_SKELETONS; ++i) {
+		self->skeletons[i] = spSkeleton_create(self->bones.skeletonData);
+		spSkeleton_updateWorldTransform(self->skeletons[i]);
+	}
+	self->pipeline = spVertexPipeline_create(0);
+	self->vertices = MALLOC(float, spVertexPipeline_layout(self->pipeline, self->skeletons, PIPELINE_SKELETONS));
+	printf("# pipeline threads\t%d\n", self->pipeline->threadsCount);
+}
+
+static void pipelineSerialRun (void* state) {
+	PipelineState* self = (PipelineState*)state;
+	int i, ii;
+	for (i = 0; i < PIPELINE_SKELETONS; ++i) {
+		spSkeleton* skeleton = self->skeletons[i];
+		const int* offsets = spVertexPipeline_getOffsets(self->pipeline, i);
+		for (ii = 0; ii < skeleton->slotsCount; ++ii) {
+			spSlot* slot = skeleton->slots[ii];
+			float* worldVertices = self->vertices + offsets[ii];
+			if (offsets[ii] < 0) continue;
+			if (slot->attachment->type == SP_ATTACHMENT_REGION)
+				spRegionAttachment_computeWorldVertices(SUB_CAST(spRegionAttachment, slot->attachment), skeleton->x, skeleton->y,
+						slot->bone, worldVertices);
+			else if (slot->attachment->type == SP_ATTACHMENT_MESH)
+				spMeshAttachment_computeWorldVertices(SUB_CAST(spMeshAttachment, slot->attachment), skeleton->x, skeleton->y,
+						slot, worldVertices);
+			else
+				spSkinnedMeshAttachment_computeWorldVertices(SUB_CAST(spSkinnedMeshAttachment, slot->attachment), skeleton->x,
+						skeleton->y, slot, worldVertices);
+		}
+	}
+}
+
+static void pipelineRun (void* state) {
+	PipelineState* self = (PipelineState*)state;
+	spVertexPipeline_compute(self->pipeline, self->vertices);
+}
+
+static void pipelineTeardown (void* state) {
+	PipelineState* self = (PipelineState*)state;
+	int i;
+	FREE(self->vertices);
+	spVertexPipeline_dispose(self->pipeline);
+	for (i = 0; i < PIPELINE_SKELETONS; ++i)
+		spSkeleton_dispose(self->skeletons[i]);
+	bonesTeardown(&self->bones);
+}
+
+/* spAnimation_apply of an animation with a timeline per bone and slot. */
+
+typedef struct {
+	BonesState bones;
+	spAnimation* animation;
+	float time;
+} ApplyState;
+
+static void applySetup (void* state) {
+	ApplyState* self = (ApplyState*)state;
+	bonesSetup(&self->bones);
+	self->animation = self->bones.skeletonData->animations[0];
+	printf("# timelines\t%d\n", self->animation->timelinesCount);
+}
+
+static void applyRun (void* state) {
+	ApplyState* self = (ApplyState*)state;
+	float lastTime = self->time;
+	self->time += 1 / 60.0f;
+	spAnimation_apply(self->animation, self->bones.skeleton, lastTime, self->time, 1, 0, 0);
+}
+
+static void applyTeardown (void* state) {
+	ApplyState* self = (ApplyState*)state;
+	bonesTeardown(&self->bones);
+}
+
+/* _SP_ARRAY growth. */
+
+#define ARRAY_ITEMS 1024
+
+static void arrayAddRun (void* state) {
+	spFloatArray* array = spFloatArray_create(0);
+	int i;
+	UNUSED(state);
+	for (i = 0; i < ARRAY_ITEMS; ++i)
+		spFloatArray_add(array, (float)i);
+	spFloatArray_dispose(array);
+}
+
+static void arrayAddAllRun (void* state) {
+	static float values[64];
+	spFloatArray* array = spFloatArray_create(0);
+	int i;
+	UNUSED(state);
+	for (i = 0; i < ARRAY_ITEMS / 64; ++i)
+		spFloatArray_addAllValues(array, values, 0, 64);
+	spFloatArray_dispose(array);
+}
+
+/* Appends an array to itself, which grows and moves the items being copied, and checks the result. */
+static void arrayAddAllSelfRun (void* state) {
+	spIntArray* array = spIntArray_create(0);
+	int i;
+	UNUSED(state);
+	for (i = 0; i < 8; ++i)
+		spIntArray_add(array, i);
+	for (i = 0; i < 8; ++i)
+		spIntArray_addAll(array, array);
+	for (i = 0; i < array->size; ++i) {
+		if (array->items[i] == i % 8) continue;
+		fprintf(stderr, "array_add_all_self: item %d is %d, expected %d.\n", i, array->items[i], i % 8);
+		exit(1);
+	}
+	spIntArray_dispose(array);
+}
+
+/* Allocator overhead through _spMalloc and _spFree. */
+
+static void mallocFreeRun (void* state) {
+	char* block = MALLOC(char, 32);
+	UNUSED(state);
+	block[0] = 0;
+	FREE(block);
+}
+
+#define BATCH_SIZE 256
+
+static void mallocFreeBatchRun (void* state) {
+	void* blocks[BATCH_SIZE];
+	int i;
+	UNUSED(state);
+	for (i = 0; i < BATCH_SIZE; ++i)
+		blocks[i] = MALLOC(char, 16 + (i * 37) % 496);
+	for (i = 0; i < BATCH_SIZE; ++i)
+		FREE(blocks[i]);
+}
+
+/**/
+
+static int compareDoubles (const void* a, const void* b) {
+	double valueA = *(const double*)a, valueB = *(const double*)b;
+	return valueA < valueB ? -1 : valueA > valueB ? 1 : 0;
+}
+
+static void runBenchmark (const Benchmark* benchmark, int samplesCount, double minNs) {
+	double* samples = (double*)malloc(sizeof(double) * samplesCount);
+	long iterations = 1, i;
+	size_t bytes = 0, allocations = 0;
+	int sample;
+
+	if (benchmark->setup) benchmark->setup(benchmark->state);
+
+	/* Double the iterations until a sample takes long enough. */
+	for (;;) {
+		double start = nowNs();
+		for (i = 0; i < iterations; ++i)
+			benchmark->run(benchmark->state);
+		if (nowNs() - start >= minNs || iterations >= (1L << 30)) break;
+		iterations *= 2;
+	}
+
+	for (sample = 0; sample < samplesCount; ++sample) {
+		double start;
+		allocatedBytes = allocationsCount = 0;
+		start = nowNs();
+		for (i = 0; i < iterations; ++i)
+			benchmark->run(benchmark->state);
+		samples[sample] = (nowNs() - start) / (double)iterations;
+		bytes = allocatedBytes;
+		allocations = allocationsCount;
+	}
+	qsort(samples, samplesCount, sizeof(double), compareDoubles);
+
+	printf("%s\t%ld\t%.1f\t%.1f\t%.2f\n", benchmark->name, iterations, samples[samplesCount / 2],
+			(double)bytes / (double)iterations, (double)allocations / (double)iterations);
+	fflush(stdout);
+
+	if (benchmark->teardown) benchmark->teardown(benchmark->state);
+	free(samples);
+}
+
+int main (int argc, char** argv) {
+	static LoadState small, medium, large, regions;
+	static BakeState bakedSmall, bakedMedium, bakedLarge, bakedRegions;
+	static DecodeState varints, floatArrays;
+	/* Loads dominated by draw order offsets, which are varints, and by the floats of one large mesh. */
+	static LoadState drawOrderHeavy = {.params = {.bonesCount = 1, .slotsCount = 64, .regionsCount = 16, .animationsCount = 1,
+			.framesCount = 1, .drawOrderFrames = 2000, .drawOrderOffsets = 32}};
+	static LoadState largeMesh = {.params = {.bonesCount = 1, .slotsCount = 1, .meshVertices = 20000, .regionsCount = 1}};
+	static BonesState deep = {.params = {.bonesCount = 256, .boneBranching = 1, .slotsCount = 1, .regionsCount = 1}};
+	static BonesState wide = {.params = {.bonesCount = 1024, .boneBranching = 1024, .slotsCount = 1, .regionsCount = 1}};
+	static SkinningState skinning = {.bones = {.params = {.bonesCount = 64, .boneBranching = 4, .slotsCount = 1,
+			.meshVertices = 4000, .bonesPerVertex = 4, .regionsCount = 1}}};
+	static PipelineState pipeline = {.bones = {.params = {.bonesCount = 64, .boneBranching = 4, .slotsCount = 16,
+			.meshVertices = 1000, .bonesPerVertex = 4, .regionsCount = 4}}};
+	static ApplyState apply = {.bones = {.params = {.bonesCount = 256, .boneBranching = 4, .slotsCount = 256,
+			.regionsCount = 16, .animationsCount = 1, .framesCount = 30, .boneTimelines = 256, .slotTimelines = 256}}};
+	Benchmark benchmarks[] = {
+		{"load_small", loadSetup, loadRun, loadTeardown, &small},
+		{"load_medium", loadSetup, loadRun, loadTeardown, &medium},
+		{"load_large", loadSetup, loadRun, loadTeardown, &large},
+		{"load_regions_4096", loadSetup, loadRun, loadTeardown, &regions},
+		{"load_regions_4096_scan", loadSetup, loadScanRun, loadTeardown, &regions},
+		{"bake_read_small", bakeSetup, bakeRun, bakeTeardown, &bakedSmall},
+		{"bake_read_medium", bakeSetup, bakeRun, bakeTeardown, &bakedMedium},
+		{"bake_read_large", bakeSetup, bakeRun, bakeTeardown, &bakedLarge},
+		{"bake_write_medium", bakeSetup, bakeWriteRun, bakeTeardown, &bakedMedium},
+		{"bake_write_regions_4096", bakeSetup, bakeWriteRun, bakeTeardown, &bakedRegions},
+		{"load_draw_order_heavy", loadSetup, loadRun, loadTeardown, &drawOrderHeavy},
+		{"load_large_mesh", loadSetup, loadRun, loadTeardown, &largeMesh},
+		{"read_varint", readVarintSetup, readVarintRun, decodeTeardown, &varints},
+		{"read_float_array", readFloatArraySetup, readFloatArrayRun, decodeTeardown, &floatArrays},
+		{"bone_update_deep", bonesSetup, bonesRun, bonesTeardown, &deep},
+		{"bone_update_wide", bonesSetup, bonesRun, bonesTeardown, &wide},
+		{"skin_attachment", skinningSetup, skinningAttachmentRun, skinningTeardown, &skinning},
+		{"skin_mesh", skinningSetup, skinningMeshRun, skinningTeardown, &skinning},
+		{"skin_batch_16", skinningSetup, skinningBatchRun, skinningTeardown, &skinning},
+		{"vertices_serial_32", pipelineSetup, pipelineSerialRun, pipelineTeardown, &pipeline},
+		{"vertices_pipeline_32", pipelineSetup, pipelineRun, pipelineTeardown, &pipeline},
+		{"animation_apply", applySetup, applyRun, applyTeardown, &apply},
+		{"array_add", 0, arrayAddRun, 0, 0},
+		{"array_add_all", 0, arrayAddAllRun, 0, 0},
+		{"array_add_all_self", 0, arrayAddAllSelfRun, 0, 0},
+		{"malloc_free", 0, mallocFreeRun, 0, 0},
+		{"malloc_free_batch", 0, mallocFreeBatchRun, 0, 0}
+	};
+	const char* filter = 0;
+	int samplesCount = 5, minMs = 100, pool = 0, i;
+
+	for (i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--pool") == 0)
+			pool = 1;
+		else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+			filter = argv[++i];
+		else if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc)
+			samplesCount = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--min-ms") == 0 && i + 1 < argc)
+			minMs = atoi(argv[++i]);
+		else {
+			fprintf(stderr, "Usage: %s [--pool] [--filter TEXT] [--samples N] [--min-ms N]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (samplesCount < 1) samplesCount = 1;
+	if (minMs < 1) minMs = 1;
+
+	spSkeletonGeneratorParams_setPreset(&small.params, "small");
+	spSkeletonGeneratorParams_setPreset(&medium.params, "medium");
+	spSkeletonGeneratorParams_setPreset(&large.params, "large");
+	/* 5184 region and bounding box attachments, in the default skin and 8 others, against a 4096 region atlas. */
+	spSkeletonGeneratorParams_setPreset(&regions.params, "large");
+	regions.params.slotsCount = 512;
+	regions.params.skinsCount = 8;
+	regions.params.meshVertices = 0;
+	regions.params.regionsCount = 4096;
+	regions.params.animationsCount = 0;
+	spSkeletonGeneratorParams_setPreset(&bakedSmall.load.params, "small");
+	spSkeletonGeneratorParams_setPreset(&bakedMedium.load.params, "medium");
+	spSkeletonGeneratorParams_setPreset(&bakedLarge.load.params, "large");
+	bakedRegions.load.params = regions.params;
+
+	if (pool) {
+		baseMalloc = spPoolAllocator_malloc;
+		baseRealloc = spPoolAllocator_realloc;
+		baseFree = spPoolAllocator_free;
+	}
+	_spSetDebugMalloc(0);
+	_spSetMalloc(countingMalloc);
+	_spSetRealloc(countingRealloc);
+	_spSetFree(countingFree);
+
+	printf("# allocator\t%s\n", pool ? "pool" : "system");
+	printf("benchmark\titerations\tns_per_op\tbytes_per_op\tallocations_per_op\n");
+	for (i = 0; i < (int)(sizeof(benchmarks) / sizeof(benchmarks[0])); ++i) {
+		if (filter && !strstr(benchmarks[i].name, filter)) continue;
+		runBenchmark(&benchmarks[i], samplesCount, minMs * 1e6);
+	}
+	return 0;
+}
+
+/**/
+
+void _spAtlasPage_createTexture (spAtlasPage* self, const char* path) {
+	UNUSED(self);
+	UNUSED(path);
+}
+
+void _spAtlasPage_disposeTexture (spAtlasPage* self) {
+	UNUSED(self);
+}
+
+char* _spUtil_readFile (const char* path, int* length) {
+	return _spReadFile(path, length);
+}
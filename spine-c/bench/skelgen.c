@@ -0,0 +1,122 @@
+/*
+ * Writes a synthetic skeleton and its atlas for load testing.
+ *   cc -O2 -Ispine-c/include spine-c/bench/skelgen.c spine-c/bench/SkeletonGenerator.c -o skelgen
+ *   ./skelgen --preset medium --animations 500 -o medium.skel
+ *
+ * The atlas is written next to the skeleton with the .atlas extension. Options override the preset, which is "small" by
+ * default. Run without arguments for the list of options.
+ */
+
+#include "SkeletonGenerator.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+	const char* option;
+	size_t offset;
+	const char* help;
+} Option;
+
+static const Option options[] = {
+	{"--bones", offsetof(spSkeletonGeneratorParams, bonesCount), "bones"},
+	{"--branching", offsetof(spSkeletonGeneratorParams, boneBranching), "children per bone, 1 makes a chain"},
+	{"--ik", offsetof(spSkeletonGeneratorParams, ikConstraintsCount), "IK constraints"},
+	{"--slots", offsetof(spSkeletonGeneratorParams, slotsCount), "slots"},
+	{"--skins", offsetof(spSkeletonGeneratorParams, skinsCount), "skins besides the default skin"},
+	{"--mesh-vertices", offsetof(spSkeletonGeneratorParams, meshVertices), "vertices per mesh, 0 for regions only"},
+	{"--bones-per-vertex", offsetof(spSkeletonGeneratorParams, bonesPerVertex), "weights per vertex, 0 for plain meshes"},
+	{"--bounding-boxes", offsetof(spSkeletonGeneratorParams, boundingBoxes), "1 adds bounding boxes"},
+	{"--regions", offsetof(spSkeletonGeneratorParams, regionsCount), "atlas regions"},
+	{"--animations", offsetof(spSkeletonGeneratorParams, animationsCount), "animations"},
+	{"--frames", offsetof(spSkeletonGeneratorParams, framesCount), "keys per timeline"},
+	{"--bone-timelines", offsetof(spSkeletonGeneratorParams, boneTimelines), "keyed bones per animation"},
+	{"--slot-timelines", offsetof(spSkeletonGeneratorParams, slotTimelines), "keyed slots per animation"},
+	{"--ffd", offsetof(spSkeletonGeneratorParams, ffdTimelines), "FFD keyed meshes per animation"},
+	{"--draw-order", offsetof(spSkeletonGeneratorParams, drawOrderFrames), "draw order keys per animation"},
+	{"--draw-order-offsets", offsetof(spSkeletonGeneratorParams, drawOrderOffsets), "slots moved per draw order key"},
+	{"--events", offsetof(spSkeletonGeneratorParams, eventsCount), "events"},
+	{"--nonessential", offsetof(spSkeletonGeneratorParams, nonessential), "1 writes nonessential data"}
+};
+
+#define OPTIONS_COUNT (int)(sizeof(options) / sizeof(options[0]))
+
+static void printUsage (const char* program) {
+	int i;
+	fprintf(stderr, "Usage: %s [--preset small|medium|large|huge] [options] -o file.skel\n", program);
+	for (i = 0; i < OPTIONS_COUNT; ++i)
+		fprintf(stderr, "  %-22s N  %s\n", options[i].option, options[i].help);
+}
+
+static int writeFile (const char* path, const void* data, int length) {
+	FILE* file = fopen(path, "wb");
+	int written;
+	if (!file) return 0;
+	written = (int)fwrite(data, 1, length, file);
+	return fclose(file) == 0 && written == length;
+}
+
+int main (int argc, char** argv) {
+	spSkeletonGeneratorParams params;
+	const char* output = 0;
+	char* atlasPath, *extension;
+	unsigned char* skeleton;
+	char* atlas;
+	int length, atlasLength, i, ii;
+
+	spSkeletonGeneratorParams_setPreset(&params, "small");
+	for (i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+			output = argv[++i];
+			continue;
+		}
+		if (strcmp(argv[i], "--preset") == 0 && i + 1 < argc) {
+			spSkeletonGeneratorParams preset;
+			if (!spSkeletonGeneratorParams_setPreset(&preset, argv[++i])) {
+				fprintf(stderr, "Unknown preset: %s\n", argv[i]);
+				return 1;
+			}
+			params = preset;
+			continue;
+		}
+		for (ii = 0; ii < OPTIONS_COUNT; ++ii)
+			if (strcmp(argv[i], options[ii].option) == 0) break;
+		if (ii == OPTIONS_COUNT || i + 1 == argc) {
+			printUsage(argv[0]);
+			return 1;
+		}
+		*(int*)((char*)&params + options[ii].offset) = atoi(argv[++i]);
+	}
+	if (!output) {
+		printUsage(argv[0]);
+		return 1;
+	}
+
+	skeleton = spSkeletonGenerator_write(&params, &length);
+	if (!skeleton) {
+		fprintf(stderr, "Out of memory or skeleton larger than 2GB.\n");
+		return 1;
+	}
+	if (!writeFile(output, skeleton, length)) {
+		fprintf(stderr, "Unable to write: %s\n", output);
+		return 1;
+	}
+	free(skeleton);
+
+	/* Replace the extension of the skeleton path, or append one. */
+	atlasPath = (char*)malloc(strlen(output) + 7);
+	strcpy(atlasPath, output);
+	extension = strrchr(atlasPath, '.');
+	if (extension && !strchr(extension, '/') && !strchr(extension, '\\')) *extension = 0;
+	strcat(atlasPath, ".atlas");
+	atlas = spSkeletonGenerator_writeAtlas(&params, "skeleton.png", &atlasLength);
+	if (!atlas || !writeFile(atlasPath, atlas, atlasLength)) {
+		fprintf(stderr, "Unable to write: %s\n", atlasPath);
+		return 1;
+	}
+	printf("%s\t%d bytes\n%s\t%d bytes\n", output, length, atlasPath, atlasLength);
+	free(atlas);
+	free(atlasPath);
+	return 0;
+}
@@ -0,0 +1,67 @@
+#ifndef SPINE_ALLOCATOR_H_
+#define SPINE_ALLOCATOR_H_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Allocator context. While a context is current on a thread, every MALLOC, REALLOC and FREE made by the runtime on that
+ * thread goes to it instead of the process wide hooks set with _spSetMalloc and friends, which remain the default context.
+ *
+ * Memory must be freed under the context it was allocated in. Objects created under a context are therefore disposed with
+ * the same context current, as spSkeletonBinary_disposeSkeletonData does for the binary's context. A context whose
+ * deallocate is 0 is dispose-only: FREE under it does nothing, and its memory is only given back all at once, such as with
+ * spArena_dispose. Objects created under a dispose-only context are never disposed, they are dropped with the context.
+ */
+typedef struct spAllocator {
+	void* (*allocate) (void* userData, size_t size, const char* file, int line);
+	void* (*reallocate) (void* userData, void* ptr, size_t size);
+	void (*deallocate) (void* userData, void* ptr); /* 0 for a dispose-only context. */
+	void* userData;
+} spAllocator;
+
+/* Makes allocator current on the calling thread and returns the previous one, which the caller restores when done. 0 selects
+ * the default context. */
+const spAllocator* spAllocator_setCurrent (const spAllocator* allocator);
+const spAllocator* spAllocator_getCurrent ();
+
+/**/
+
+/*
+ * Arena allocator, a dispose-only context. Blocks are carved from chunks and only given back when the arena is disposed,
+ * apart from the most recent block which can be grown in place. Suited to loading a skeleton for a session and dropping it
+ * in one go: skeleton data read under an arena is released with spArena_dispose and must never be passed to
+ * spSkeletonData_dispose, which would free arena blocks under the caller's context. spSkeleton and spAnimationState created
+ * from such data with no context current allocate from the caller's context as usual and are disposed as usual, before the
+ * arena. An arena must only be current on one thread at a time.
+ */
+typedef struct spArena {
+	spAllocator super;
+	const size_t liveBytes; /* Requested bytes of the blocks, as last reallocated. */
+	const size_t peakBytes;
+	const size_t reservedBytes; /* Bytes held in chunks. */
+	const int allocationsCount;
+} spArena;
+
+/* chunkSize of 0 uses 64KB. Chunks come from the system allocator. */
+spArena* spArena_create (size_t chunkSize);
+/* Frees every block allocated from the arena. */
+void spArena_dispose (spArena* self);
+
+#ifdef SPINE_SHORT_NAMES
+typedef spAllocator Allocator;
+typedef spArena Arena;
+#define Allocator_setCurrent(...) spAllocator_setCurrent(__VA_ARGS__)
+#define Allocator_getCurrent(...) spAllocator_getCurrent(__VA_ARGS__)
+#define Arena_create(...) spArena_create(__VA_ARGS__)
+#define Arena_dispose(...) spArena_dispose(__VA_ARGS__)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SPINE_ALLOCATOR_H_ */
@@ -43,6 +43,8 @@ extern "C" {
     SP_API void name##_clear(name* self); \
     SP_API name* name##_setSize(name* self, int newSize); \
     SP_API void name##_ensureCapacity(name* self, int newCapacity); \
+    SP_API void name##_shrinkToFit(name* self); \
+    SP_API itemType* name##_release(name* self); \
     SP_API void name##_add(name* self, itemType value); \
     SP_API void name##_addAll(name* self, name* other); \
     SP_API void name##_addAllValues(name* self, itemType* values, int offset, int count); \
@@ -60,8 +62,8 @@ extern "C" {
         return array; \
     } \
     void name##_dispose(name* self) { \
-        FREE(self->items); \
-        FREE(self); \
+        FREE_SIZED(self->items, itemType, self->capacity); \
+        FREE_SIZED(self, name, 1); \
     } \
     void name##_clear(name* self) { \
         self->size = 0; \
@@ -79,6 +81,22 @@ extern "C" {
         self->capacity = newCapacity; \
         self->items = REALLOC(self->items, itemType, self->capacity); \
     } \
+    void name##_shrinkToFit(name* self) { \
+        if (self->capacity == self->size) return; \
+        if (self->size == 0) { \
+            FREE_SIZED(self->items, itemType, self->capacity); \
+            self->items = 0; \
+        } else \
+            self->items = REALLOC(self->items, itemType, self->size); \
+        self->capacity = self->size; \
+    } \
+    itemType* name##_release(name* self) { \
+        itemType* items; \
+        name##_shrinkToFit(self); \
+        items = self->items; \
+        FREE_SIZED(self, name, 1); \
+        return items; \
+    } \
     void name##_add(name* self, itemType value) { \
         if (self->size == self->capacity) { \
             self->capacity = MAX(8, (int)(self->size * 1.75f)); \
@@ -87,16 +105,18 @@ extern "C" {
         self->items[self->size++] = value; \
     } \
     void name##_addAll(name* self, name* other) { \
-        int i = 0; \
-        for (; i < other->size; i++) { \
-            name##_add(self, other->items[i]); \
-        } \
+        name##_addAllValues(self, other->items, 0, other->size); \
     } \
     void name##_addAllValues(name* self, itemType* values, int offset, int count) { \
-        int i = offset, n = offset + count; \
-        for (; i < n; i++) { \
-            name##_add(self, values[i]); \
+        if (count <= 0) return; \
+        if (self->size + count > self->capacity) { \
+            /* values may point into items, which growing moves. */ \
+            int index = values >= self->items && values < self->items + self->size ? (int)(values - self->items) : -1; \
+            name##_ensureCapacity(self, MAX(self->size + count, (int)(self->capacity * 1.75f))); \
+            if (index != -1) values = self->items + index; \
         } \
+        memcpy(self->items + self->size, values + offset, sizeof(itemType) * count); \
+        self->size += count; \
     } \
     void name##_removeAt(name* self, int index) { \
         self->size--; \
@@ -127,8 +147,8 @@ extern "C" {
         return array; \
     } \
     void name##_dispose(name* self) { \
-        FREE(self->items); \
-        FREE(self); \
+        FREE_SIZED(self->items, itemType, self->capacity); \
+        FREE_SIZED(self, name, 1); \
     } \
     void name##_clear(name* self) { \
         self->size = 0; \
@@ -146,6 +166,22 @@ extern "C" {
         self->capacity = newCapacity; \
         self->items = REALLOC(self->items, itemType, self->capacity); \
     } \
+    void name##_shrinkToFit(name* self) { \
+        if (self->capacity == self->size) return; \
+        if (self->size == 0) { \
+            FREE_SIZED(self->items, itemType, self->capacity); \
+            self->items = 0; \
+        } else \
+            self->items = REALLOC(self->items, itemType, self->size); \
+        self->capacity = self->size; \
+    } \
+    itemType* name##_release(name* self) { \
+        itemType* items; \
+        name##_shrinkToFit(self); \
+        items = self->items; \
+        FREE_SIZED(self, name, 1); \
+        return items; \
+    } \
     void name##_add(name* self, itemType value) { \
         if (self->size == self->capacity) { \
             self->capacity = MAX(8, (int)(self->size * 1.75f)); \
@@ -154,16 +190,18 @@ extern "C" {
         self->items[self->size++] = value; \
     } \
     void name##_addAll(name* self, name* other) { \
-        int i = 0; \
-        for (; i < other->size; i++) { \
-            name##_add(self, other->items[i]); \
-        } \
+        name##_addAllValues(self, other->items, 0, other->size); \
     } \
     void name##_addAllValues(name* self, itemType* values, int offset, int count) { \
-        int i = offset, n = offset + count; \
-        for (; i < n; i++) { \
-            name##_add(self, values[i]); \
+        if (count <= 0) return; \
+        if (self->size + count > self->capacity) { \
+            /* values may point into items, which growing moves. */ \
+            int index = values >= self->items && values < self->items + self->size ? (int)(values - self->items) : -1; \
+            name##_ensureCapacity(self, MAX(self->size + count, (int)(self->capacity * 1.75f))); \
+            if (index != -1) values = self->items + index; \
         } \
+        memcpy(self->items + self->size, values + offset, sizeof(itemType) * count); \
+        self->size += count; \
     } \
     void name##_removeAt(name* self, int index) { \
         self->size--; \
@@ -177,6 +215,88 @@ extern "C" {
         return self->items[self->size - 1]; \
     }
 
+/* Array with room for inlineCapacity items inside the struct, so it can live on the stack or in another struct. Items
+ * move to the heap only when it grows past inlineCapacity. Call init before use and deinit when done. While the items are
+ * inline, the struct must not be copied. */
+#define _SP_ARRAY_INLINE_STRUCT(name, itemType, inlineCapacity) \
+    typedef struct name { int size; int capacity; itemType* items; itemType inlineItems[inlineCapacity]; } name;
+
+#define _SP_ARRAY_DECLARE_TYPE_INLINE(name, itemType, inlineCapacity) \
+    _SP_ARRAY_INLINE_STRUCT(name, itemType, inlineCapacity) \
+    SP_API void name##_init(name* self); \
+    SP_API void name##_deinit(name* self); \
+    SP_API void name##_clear(name* self); \
+    SP_API name* name##_setSize(name* self, int newSize); \
+    SP_API void name##_ensureCapacity(name* self, int newCapacity); \
+    SP_API void name##_add(name* self, itemType value); \
+    SP_API void name##_addAllValues(name* self, itemType* values, int offset, int count); \
+    SP_API itemType name##_pop(name* self); \
+    SP_API itemType name##_peek(name* self);
+
+#define _SP_ARRAY_IMPLEMENT_TYPE_INLINE(name, itemType, inlineCapacity) \
+    _SP_ARRAY_IMPLEMENT_TYPE_INLINE_WITH(name, itemType, inlineCapacity, extern)
+
+/* Defines the struct and functions of an inline array local to the translation unit, for scratch types that are not part of
+ * the API. The functions are static inline so those a file does not call raise no warning. */
+#if defined(_MSC_VER)
+#define _SP_ARRAY_STATIC static __inline
+#else
+#define _SP_ARRAY_STATIC static __inline__
+#endif
+#define _SP_ARRAY_DEFINE_TYPE_INLINE_STATIC(name, itemType, inlineCapacity) \
+    _SP_ARRAY_INLINE_STRUCT(name, itemType, inlineCapacity) \
+    _SP_ARRAY_IMPLEMENT_TYPE_INLINE_WITH(name, itemType, inlineCapacity, _SP_ARRAY_STATIC)
+
+#define _SP_ARRAY_IMPLEMENT_TYPE_INLINE_WITH(name, itemType, inlineCapacity, linkage) \
+    linkage void name##_init(name* self) { \
+        self->size = 0; \
+        self->capacity = inlineCapacity; \
+        self->items = self->inlineItems; \
+    } \
+    linkage void name##_deinit(name* self) { \
+        if (self->items != self->inlineItems) FREE_SIZED(self->items, itemType, self->capacity); \
+        name##_init(self); \
+    } \
+    linkage void name##_clear(name* self) { \
+        self->size = 0; \
+    } \
+    linkage void name##_ensureCapacity(name* self, int newCapacity) { \
+        if (self->capacity >= newCapacity) return; \
+        if (self->items == self->inlineItems) { \
+            self->items = MALLOC(itemType, newCapacity); \
+            memcpy(self->items, self->inlineItems, sizeof(itemType) * self->size); \
+        } else \
+            self->items = REALLOC(self->items, itemType, newCapacity); \
+        self->capacity = newCapacity; \
+    } \
+    linkage name* name##_setSize(name* self, int newSize) { \
+        if (self->capacity < newSize) name##_ensureCapacity(self, MAX(newSize, (int)(self->capacity * 1.75f))); \
+        self->size = newSize; \
+        return self; \
+    } \
+    linkage void name##_add(name* self, itemType value) { \
+        if (self->size == self->capacity) name##_ensureCapacity(self, (int)(self->capacity * 1.75f) + 1); \
+        self->items[self->size++] = value; \
+    } \
+    linkage void name##_addAllValues(name* self, itemType* values, int offset, int count) { \
+        if (count <= 0) return; \
+        if (self->size + count > self->capacity) { \
+            /* values may point into items, which growing moves. */ \
+            int index = values >= self->items && values < self->items + self->size ? (int)(values - self->items) : -1; \
+            name##_ensureCapacity(self, MAX(self->size + count, (int)(self->capacity * 1.75f))); \
+            if (index != -1) values = self->items + index; \
+        } \
+        memcpy(self->items + self->size, values + offset, sizeof(itemType) * count); \
+        self->size += count; \
+    } \
+    linkage itemType name##_pop(name* self) { \
+        itemType item = self->items[--self->size]; \
+        return item; \
+    } \
+    linkage itemType name##_peek(name* self) { \
+        return self->items[self->size - 1]; \
+    }
+
 _SP_ARRAY_DECLARE_TYPE(spFloatArray, float)
 
 _SP_ARRAY_DECLARE_TYPE(spIntArray, int)
@@ -0,0 +1,46 @@
+#ifndef SPINE_ATLASINDEX_H_
+#define SPINE_ATLASINDEX_H_
+
+#include <spine/Atlas.h>
+#include <spine/AtlasAttachmentLoader.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * A hash index of an atlas's regions by name. spAtlas_findRegion compares the name with every region in turn, so creating
+ * the attachments of a skeleton costs a scan of the atlas per attachment. The index finds a region in constant time.
+ *
+ * The atlas attachment loader builds one for its atlas on first use. An index can also be built once per atlas and shared
+ * by several loaders, including loaders on other threads, as it is only read once built. The atlas must outlive the index
+ * and its regions must not change.
+ */
+
+typedef struct spAtlasIndex {
+	const spAtlas* const atlas;
+	const int regionsCount; /* Indexed, one per name. */
+} spAtlasIndex;
+
+spAtlasIndex* spAtlasIndex_create (const spAtlas* atlas);
+void spAtlasIndex_dispose (spAtlasIndex* self);
+
+/* Returns the region spAtlas_findRegion returns, the first with the name, or 0. */
+spAtlasRegion* spAtlasIndex_findRegion (const spAtlasIndex* self, const char* name);
+
+/* An atlas attachment loader for the index's atlas which finds regions through the index. The index must outlive it. */
+spAtlasAttachmentLoader* spAtlasAttachmentLoader_createWithIndex (const spAtlasIndex* index);
+
+#ifdef SPINE_SHORT_NAMES
+typedef spAtlasIndex AtlasIndex;
+#define AtlasIndex_create(...) spAtlasIndex_create(__VA_ARGS__)
+#define AtlasIndex_dispose(...) spAtlasIndex_dispose(__VA_ARGS__)
+#define AtlasIndex_findRegion(...) spAtlasIndex_findRegion(__VA_ARGS__)
+#define AtlasAttachmentLoader_createWithIndex(...) spAtlasAttachmentLoader_createWithIndex(__VA_ARGS__)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SPINE_ATLASINDEX_H_ */
@@ -0,0 +1,39 @@
+#ifndef SPINE_POOLALLOCATOR_H_
+#define SPINE_POOLALLOCATOR_H_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Size-class pool allocator for the many small objects the runtime creates (bones, slots, timelines, events, array headers).
+ * Blocks up to 512 bytes come from per-thread caches that need no locking. A block freed on another thread is pushed onto
+ * the owning cache's remote list without locks and reused by the owner on its next refill. Larger blocks go to the system
+ * allocator.
+ *
+ * Pooled memory is kept for the life of the process. Caches of threads that exit are not reclaimed, so the pool suits a
+ * fixed set of long lived threads.
+ */
+
+void* spPoolAllocator_malloc (size_t size);
+void* spPoolAllocator_realloc (void* ptr, size_t size);
+void spPoolAllocator_free (void* ptr);
+
+/* Installs the pool through _spSetMalloc, _spSetRealloc and _spSetFree and clears any debug malloc. Call it before the
+ * runtime allocates anything, since memory from the previous allocator cannot be freed by the pool. */
+void spPoolAllocator_install ();
+
+#ifdef SPINE_SHORT_NAMES
+#define PoolAllocator_malloc(...) spPoolAllocator_malloc(__VA_ARGS__)
+#define PoolAllocator_realloc(...) spPoolAllocator_realloc(__VA_ARGS__)
+#define PoolAllocator_free(...) spPoolAllocator_free(__VA_ARGS__)
+#define PoolAllocator_install(...) spPoolAllocator_install(__VA_ARGS__)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SPINE_POOLALLOCATOR_H_ */
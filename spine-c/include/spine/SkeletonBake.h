@@ -0,0 +1,41 @@
+#ifndef SPINE_SKELETONBAKE_H_
+#define SPINE_SKELETONBAKE_H_
+
+#include <spine/SkeletonBinary.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Baked skeleton images, a fast load format for skeleton data that has already been read once, for example at build time.
+ * An image holds the skeleton data as it is in memory: native byte order, values already scaled, curves already sampled and
+ * references stored as indices. Reading one is a single pass of bounds checked copies, without varint decoding, byte
+ * swapping, scaling or curve evaluation.
+ *
+ * Images are only read by a runtime with the same byte order and format version, and fail to read otherwise. Keep the
+ * original skeleton file to bake again.
+ */
+
+#define SP_SKELETON_BAKE_VERSION 3
+
+/* Returns the baked image of skeletonData, to be released with FREE. The triangles of meshes read with
+ * spSkeletonBinary::poolIndices are baked as int triangles, as if read without pooling. Returns 0 if a mesh has neither. */
+unsigned char* spSkeletonBake_write (const spSkeletonData* skeletonData, int* length);
+
+/* Reads an image with the attachment loader and allocator of binary, whose scale is not applied again. image must be 4 byte
+ * aligned, as memory from malloc or a mapped file is. Returns 0 with binary->error set if the image cannot be read. Attachment
+ * timelines keep the attachments found when reading, so the skins must not gain or lose attachments afterwards, as with
+ * spSkeletonBinary_readSkeletonData. */
+spSkeletonData* spSkeletonBake_read (spSkeletonBinary* binary, const unsigned char* image, int length);
+
+#ifdef SPINE_SHORT_NAMES
+#define SkeletonBake_write(...) spSkeletonBake_write(__VA_ARGS__)
+#define SkeletonBake_read(...) spSkeletonBake_read(__VA_ARGS__)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SPINE_SKELETONBAKE_H_ */
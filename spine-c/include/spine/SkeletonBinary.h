@@ -1,10 +1,12 @@
 ﻿#ifndef SPINE_SKELETONBINARY_H_
 #define SPINE_SKELETONBINARY_H_
 
+#include <spine/Allocator.h>
 #include <spine/Attachment.h>
 #include <spine/AttachmentLoader.h>
 #include <spine/SkeletonData.h>
 #include <spine/Atlas.h>
+#include <stdio.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -12,26 +14,208 @@ extern "C" {
 
 struct spAtlasAttachmentLoader;
 
+/*
+ * Load profile, filled by every read when the runtime is built with SPINE_BINARY_PROFILE defined. Otherwise the profile stays
+ * 0 and reading carries no overhead. Bytes are those of the skeleton data consumed. Allocations count MALLOC, CALLOC and
+ * REALLOC calls made on the reading thread, including those of the attachment loader.
+ */
+typedef enum {
+	SP_BINARY_SECTION_HEADER,
+	SP_BINARY_SECTION_BONES,
+	SP_BINARY_SECTION_IK_CONSTRAINTS,
+	SP_BINARY_SECTION_SLOTS,
+	SP_BINARY_SECTION_SKINS,
+	SP_BINARY_SECTION_EVENTS,
+	SP_BINARY_SECTION_ANIMATIONS,
+	SP_BINARY_SECTIONS_COUNT
+} spSkeletonBinarySection;
+
+typedef enum {
+	SP_BINARY_GROUP_SLOT_TIMELINES,
+	SP_BINARY_GROUP_BONE_TIMELINES,
+	SP_BINARY_GROUP_IK_TIMELINES,
+	SP_BINARY_GROUP_FFD_TIMELINES,
+	SP_BINARY_GROUP_DRAW_ORDER,
+	SP_BINARY_GROUP_EVENTS,
+	SP_BINARY_GROUPS_COUNT
+} spSkeletonBinaryTimelineGroup;
+
+typedef struct spSkeletonBinaryProfileEntry {
+	const char* name;
+	double seconds;
+	int bytes;
+	int allocations;
+	size_t allocatedBytes;
+} spSkeletonBinaryProfileEntry;
+
+typedef struct spSkeletonBinarySkinProfile {
+	spSkeletonBinaryProfileEntry super;
+	spSkeletonBinaryProfileEntry attachmentLoader; /* Part of the skin spent in spAttachmentLoader_newAttachment. */
+	int attachmentsCount;
+} spSkeletonBinarySkinProfile;
+
+typedef struct spSkeletonBinaryAnimationProfile {
+	spSkeletonBinaryProfileEntry super;
+	spSkeletonBinaryProfileEntry groups[SP_BINARY_GROUPS_COUNT];
+} spSkeletonBinaryAnimationProfile;
+
+typedef struct spSkeletonBinaryProfile {
+	spSkeletonBinaryProfileEntry total;
+	spSkeletonBinaryProfileEntry sections[SP_BINARY_SECTIONS_COUNT];
+	int skinsCount;
+	spSkeletonBinarySkinProfile* skins; /* The default skin first, if the skeleton has one. */
+	int animationsCount;
+	spSkeletonBinaryAnimationProfile* animations;
+} spSkeletonBinaryProfile;
+
+/*
+ * Selects the skins and animations a read creates. The others are skipped in the data without being decoded or allocated, as
+ * are the FFD timelines of skipped skins. The default skin is always read. The names are not copied and must be kept while
+ * reading.
+ */
+typedef struct spSkeletonBinaryFilter {
+	const char* const* skinNames; /* 0 reads every skin. */
+	int skinNamesCount;
+	const char* const* animationNames; /* 0 reads every animation. */
+	int animationNamesCount;
+} spSkeletonBinaryFilter;
+
+/*
+ * Triangle indices of every mesh and skinned mesh of a read, kept as the 16 bit values stored in the data in one buffer that
+ * can be uploaded at once. Each attachment points at its own indices, from spSkeletonIndexPool_getIndices, while its int
+ * triangles are 0 and its trianglesCount is kept. The pool lives as long as the binary or caller holding it, or any of the
+ * attachments, uses it.
+ */
+typedef struct spSkeletonIndexPool {
+	const unsigned short* const indices;
+	const int indicesCount;
+	const size_t bytes; /* Of the indices. */
+	const size_t intBytes; /* Of the int triangles the pool replaces. */
+} spSkeletonIndexPool;
+
+/* Drops the caller's hold on a pool from spSkeletonBinary_releaseIndexPool, under the allocator context it was read with,
+ * whichever context is current. The pool is freed with the last attachment using it. Does nothing for a dispose-only
+ * context, which drops the pool with the rest of its memory. */
+void spSkeletonIndexPool_dispose(spSkeletonIndexPool* self);
+/* Returns the trianglesCount indices of a mesh or skinned mesh read into an index pool, or 0 for other attachments. */
+const unsigned short* spSkeletonIndexPool_getIndices(const spAttachment* attachment);
+/* Returns the offset of the attachment's indices in the pool, or -1 if the attachment is not in it. */
+int spSkeletonIndexPool_getOffset(const spSkeletonIndexPool* self, const spAttachment* attachment);
+
+/* Geometry of the meshes and skinned meshes of a read: UVs, triangles, vertices or weights, bones and edges. */
+typedef struct spSkeletonBinaryMeshStats {
+	size_t bytes; /* As read, with arrays of their own for every mesh. */
+	size_t sharedBytes; /* Once identical arrays are shared. The same as bytes unless shareMeshes is set. */
+	int arraysCount;
+	int sharedArraysCount; /* Arrays replaced by one read before. */
+} spSkeletonBinaryMeshStats;
+
 typedef struct spSkeletonBinary {
 	float scale;
 	spAttachmentLoader* attachmentLoader;
 	const char* const error;
+	const spAllocator* const allocator; /* Current while reading and disposing. 0 for the default context. */
+	const spSkeletonBinaryProfile* const profile; /* Of the last read, kept until the next read or dispose. */
+	spSkeletonBinaryFilter filter; /* Reads everything unless set. */
+	/* Reads triangle indices into indexPool instead of each mesh's int triangles. Meshes and skinned meshes then keep their
+	 * trianglesCount with triangles set to 0: draw them from spSkeletonIndexPool_getIndices, or from the pool's buffer at
+	 * spSkeletonIndexPool_getOffset. Code that reads triangles directly must not be given such skeleton data. The attachment
+	 * loader must create meshes with spMeshAttachment_create and spSkinnedMeshAttachment_create, which keep the indices. */
+	int /*bool*/ poolIndices;
+	/* Of the last read. The next read or dispose drops the binary's hold on it unless it is released. */
+	spSkeletonIndexPool* const indexPool;
+	/* Shares the geometry arrays of meshes identical to one read before, such as the same mesh in several skins, between
+	 * the attachments. Shared arrays are counted and freed with the last attachment using them. The attachment loader must
+	 * create meshes with spMeshAttachment_create and spSkinnedMeshAttachment_create, which keep the counts. */
+	int /*bool*/ shareMeshes;
+	const spSkeletonBinaryMeshStats meshStats; /* Of the last read. */
+	/* Skips the editor data of files exported with nonessential data, mesh edges, width and height, without allocating it,
+	 * so the skeleton data is the same as that of a file exported without. */
+	int /*bool*/ skipNonessential;
 } spSkeletonBinary;
 
+/* These take the allocator that is current on the calling thread. */
 spSkeletonBinary* spSkeletonBinary_createWithLoader(spAttachmentLoader* attachmentLoader);
 spSkeletonBinary* spSkeletonBinary_create(spAtlas* atlas);
+/* The binary, its attachment loader and all skeleton data read are allocated from allocator. The skeleton data must be
+ * disposed with spSkeletonBinary_disposeSkeletonData, or, for a dispose-only allocator such as an arena, not at all. */
+spSkeletonBinary* spSkeletonBinary_createWithLoaderAndAllocator(spAttachmentLoader* attachmentLoader, const spAllocator* allocator);
+spSkeletonBinary* spSkeletonBinary_createWithAllocator(spAtlas* atlas, const spAllocator* allocator);
 void spSkeletonBinary_dispose(spSkeletonBinary* self);
 
+/* Attachment timelines of the skeleton data keep the attachments their keys name in the default skin and in each of the data's
+ * skins that has one in the slot, as found when reading, and set them without a skin lookup. The data's skins must not gain or
+ * lose attachments afterwards, or the timelines keep setting the attachments found when reading. Skins created later and
+ * skins without the name are looked up by name. */
 spSkeletonData* spSkeletonBinary_readSkeletonData(spSkeletonBinary* self, const unsigned char* binary, const int length);
 spSkeletonData* spSkeletonBinary_readSkeletonDataFile(spSkeletonBinary* self, const char* path);
+/* Disposes skeleton data read with the binary, including through spSkeletonBinaryStream and spSkeletonBake_read, with the
+ * binary's allocator current. It is the only way to dispose data read under an allocator context: spSkeletonData_dispose
+ * frees under the context current on the calling thread, which would be handed blocks it does not own. Does nothing for a
+ * dispose-only context. */
+void spSkeletonBinary_disposeSkeletonData(spSkeletonBinary* self, spSkeletonData* skeletonData);
+
+/* Writes the profile of the last read as tab separated lines: the total, each section, then each skin and animation. */
+void spSkeletonBinary_reportProfile(const spSkeletonBinary* self, FILE* file);
+
+/* Returns the index pool of the last read, which the caller then holds until spSkeletonIndexPool_dispose, or 0 if poolIndices
+ * was not set. */
+spSkeletonIndexPool* spSkeletonBinary_releaseIndexPool(spSkeletonBinary* self);
+
+/* Draw order timelines read by spSkeletonBinary and spSkeletonBake_read keep each frame as the slots it moves and expand it
+ * when applied, so their drawOrders is 0. Returns 1 with the frame's setup pose slot index at each position in drawOrder,
+ * which holds slotsCount, or 0 if the frame is the setup pose order. Takes any draw order timeline. */
+int spDrawOrderTimeline_getDrawOrder(const spDrawOrderTimeline* self, int frameIndex, int* drawOrder);
+
+/*
+ * Reads skeleton data from consecutive chunks of a file, for example as they are downloaded or decompressed, instead of one
+ * contiguous buffer. Each item (a bone, a skin, an animation and so on) is read as soon as all of its bytes have been fed, so
+ * only the bytes of the incomplete item are kept.
+ */
+typedef struct spSkeletonBinaryStream {
+	spSkeletonBinary* const binary;
+	const int bytesRead; /* Fed bytes read into the skeleton data so far. */
+	const int bufferedBytes; /* Fed bytes kept until the item they belong to is complete. */
+	const int peakBufferedBytes;
+} spSkeletonBinaryStream;
+
+/* Reads with the scale, attachment loader and allocator of binary, which reports errors and the profile. binary must outlive
+ * the stream and not read anything else meanwhile. */
+spSkeletonBinaryStream* spSkeletonBinaryStream_create(spSkeletonBinary* binary);
+void spSkeletonBinaryStream_dispose(spSkeletonBinaryStream* self);
+
+/* Returns 1 while the skeleton data is incomplete, 0 once it is complete, after which any further bytes are ignored, or -1 with
+ * binary->error set if the data is invalid. Reading a large item can lag behind the data fed, so call finish after the last
+ * chunk rather than waiting for 0. */
+int spSkeletonBinaryStream_feed(spSkeletonBinaryStream* self, const unsigned char* data, int length);
+/* Returns the skeleton data, which the caller then owns, or 0 with binary->error set if the data was invalid or incomplete. */
+spSkeletonData* spSkeletonBinaryStream_finish(spSkeletonBinaryStream* self);
 
 #ifdef SPINE_SHORT_NAMES
 typedef spSkeletonBinary SkeletonBinary;
+typedef spSkeletonBinaryProfile SkeletonBinaryProfile;
+typedef spSkeletonBinaryFilter SkeletonBinaryFilter;
+typedef spSkeletonIndexPool SkeletonIndexPool;
+typedef spSkeletonBinaryMeshStats SkeletonBinaryMeshStats;
+#define SkeletonIndexPool_dispose(...) spSkeletonIndexPool_dispose(__VA_ARGS__)
+#define SkeletonIndexPool_getIndices(...) spSkeletonIndexPool_getIndices(__VA_ARGS__)
+#define SkeletonIndexPool_getOffset(...) spSkeletonIndexPool_getOffset(__VA_ARGS__)
 #define SkeletonBinary_createWithLoader(...) spSkeletonBinary_createWithLoader(__VA_ARGS__)
 #define SkeletonBinary_create(...) spSkeletonBinary_create(__VA_ARGS__)
+#define SkeletonBinary_createWithLoaderAndAllocator(...) spSkeletonBinary_createWithLoaderAndAllocator(__VA_ARGS__)
+#define SkeletonBinary_createWithAllocator(...) spSkeletonBinary_createWithAllocator(__VA_ARGS__)
 #define SkeletonBinary_dispose(...) spSkeletonBinary_dispose(__VA_ARGS__)
 #define SkeletonBinary_readSkeletonData(...) spSkeletonBinary_readSkeletonData(__VA_ARGS__)
 #define SkeletonBinary_readSkeletonDataFile(...) spSkeletonBinary_readSkeletonDataFile(__VA_ARGS__)
+#define SkeletonBinary_disposeSkeletonData(...) spSkeletonBinary_disposeSkeletonData(__VA_ARGS__)
+#define SkeletonBinary_reportProfile(...) spSkeletonBinary_reportProfile(__VA_ARGS__)
+#define SkeletonBinary_releaseIndexPool(...) spSkeletonBinary_releaseIndexPool(__VA_ARGS__)
+#define DrawOrderTimeline_getDrawOrder(...) spDrawOrderTimeline_getDrawOrder(__VA_ARGS__)
+typedef spSkeletonBinaryStream SkeletonBinaryStream;
+#define SkeletonBinaryStream_create(...) spSkeletonBinaryStream_create(__VA_ARGS__)
+#define SkeletonBinaryStream_dispose(...) spSkeletonBinaryStream_dispose(__VA_ARGS__)
+#define SkeletonBinaryStream_feed(...) spSkeletonBinaryStream_feed(__VA_ARGS__)
+#define SkeletonBinaryStream_finish(...) spSkeletonBinaryStream_finish(__VA_ARGS__)
 #endif
 
 #ifdef __cplusplus
@@ -0,0 +1,99 @@
+#ifndef SPINE_SKELETONLOADER_H_
+#define SPINE_SKELETONLOADER_H_
+
+#include <spine/Atlas.h>
+#include <spine/SkeletonData.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Loads binary skeletons on background threads. Each load reads its file with _spUtil_readFile and parses it with a
+ * spSkeletonBinary of its worker thread, so the submitting thread only queues the load and later collects the result.
+ *
+ * Loads run by priority, then in submission order. The number of loads queued or running is bounded: when the queue is full,
+ * a load needed now takes the place of the latest queued prefetch, which is cancelled, and a prefetch is refused.
+ *
+ * Workers allocate with the default allocator context, the hooks set with _spSetMalloc and friends, which must therefore be
+ * thread safe, as must _spUtil_readFile. The atlas is only read and must outlive the loader.
+ */
+
+typedef enum {
+	SP_SKELETON_LOAD_PREFETCH, /* Wanted soon, such as the next level's skeletons. */
+	SP_SKELETON_LOAD_NEEDED /* Wanted now, run ahead of every prefetch. */
+} spSkeletonLoadPriority;
+
+typedef enum {
+	SP_SKELETON_LOAD_QUEUED,
+	SP_SKELETON_LOAD_RUNNING,
+	SP_SKELETON_LOAD_DONE,
+	SP_SKELETON_LOAD_FAILED,
+	SP_SKELETON_LOAD_CANCELLED
+} spSkeletonLoadState;
+
+typedef struct spSkeletonLoad spSkeletonLoad;
+
+/* Called by spSkeletonLoader_update on the thread calling it, once the load is done, failed or cancelled. */
+typedef void (*spSkeletonLoadCallback) (spSkeletonLoad* load, void* userData);
+
+/* The fields are final once the state is, as seen through spSkeletonLoader_getState or a callback. */
+struct spSkeletonLoad {
+	const spSkeletonLoadState state;
+	const char* const error; /* Set if the load failed. */
+	void* userData;
+};
+
+typedef struct spSkeletonLoader {
+	const int threadsCount;
+	const int maxLoads; /* Loads queued or running at once. */
+	float scale; /* Applied to loads submitted afterwards. */
+} spSkeletonLoader;
+
+/* threadsCount of 0 uses one thread per processor but one, and maxLoads of 0 allows 64 loads. */
+spSkeletonLoader* spSkeletonLoader_create (spAtlas* atlas, int threadsCount, int maxLoads);
+/* Cancels queued loads, waits for running ones and disposes every load not yet released, with its skeleton data. */
+void spSkeletonLoader_dispose (spSkeletonLoader* self);
+
+/* Returns the load, or 0 if the queue is full. The file path is copied. data is read in place and must be kept until the
+ * load is released. callback may be 0 to poll instead. */
+spSkeletonLoad* spSkeletonLoader_loadFile (spSkeletonLoader* self, const char* path, spSkeletonLoadPriority priority,
+		spSkeletonLoadCallback callback, void* userData);
+spSkeletonLoad* spSkeletonLoader_loadData (spSkeletonLoader* self, const unsigned char* data, int length,
+		spSkeletonLoadPriority priority, spSkeletonLoadCallback callback, void* userData);
+
+spSkeletonLoadState spSkeletonLoader_getState (spSkeletonLoader* self, spSkeletonLoad* load);
+/* Moves a queued load to the priority's queue, behind the loads already there. */
+void spSkeletonLoader_setPriority (spSkeletonLoader* self, spSkeletonLoad* load, spSkeletonLoadPriority priority);
+/* Blocks until the load is done, failed or cancelled, running it ahead of every other queued load. Returns its state. */
+spSkeletonLoadState spSkeletonLoader_wait (spSkeletonLoader* self, spSkeletonLoad* load);
+/* Cancels a queued load. A running load finishes, then its skeleton data is disposed. Returns 0 if the load already ended. */
+int spSkeletonLoader_cancel (spSkeletonLoader* self, spSkeletonLoad* load);
+
+/* Calls the callbacks of loads that ended since the last update and returns how many loads ended. */
+int spSkeletonLoader_update (spSkeletonLoader* self);
+
+/* Frees the load and returns its skeleton data, which the caller then owns, or 0 unless the load is done. A load that is
+ * still queued or running is cancelled. Every load must be released, from its callback or later. */
+spSkeletonData* spSkeletonLoader_release (spSkeletonLoader* self, spSkeletonLoad* load);
+
+#ifdef SPINE_SHORT_NAMES
+typedef spSkeletonLoader SkeletonLoader;
+typedef spSkeletonLoad SkeletonLoad;
+#define SkeletonLoader_create(...) spSkeletonLoader_create(__VA_ARGS__)
+#define SkeletonLoader_dispose(...) spSkeletonLoader_dispose(__VA_ARGS__)
+#define SkeletonLoader_loadFile(...) spSkeletonLoader_loadFile(__VA_ARGS__)
+#define SkeletonLoader_loadData(...) spSkeletonLoader_loadData(__VA_ARGS__)
+#define SkeletonLoader_getState(...) spSkeletonLoader_getState(__VA_ARGS__)
+#define SkeletonLoader_setPriority(...) spSkeletonLoader_setPriority(__VA_ARGS__)
+#define SkeletonLoader_wait(...) spSkeletonLoader_wait(__VA_ARGS__)
+#define SkeletonLoader_cancel(...) spSkeletonLoader_cancel(__VA_ARGS__)
+#define SkeletonLoader_update(...) spSkeletonLoader_update(__VA_ARGS__)
+#define SkeletonLoader_release(...) spSkeletonLoader_release(__VA_ARGS__)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SPINE_SKELETONLOADER_H_ */
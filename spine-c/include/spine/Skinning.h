@@ -0,0 +1,74 @@
+#ifndef SPINE_SKINNING_H_
+#define SPINE_SKINNING_H_
+
+#include <spine/Skeleton.h>
+#include <spine/SkinnedMeshAttachment.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Linear blend skinning for skinned meshes, several vertices at a time. spSkinnedMeshAttachment stores each vertex as a bone
+ * count followed by its (x, y, weight) influences, which spSkinnedMeshAttachment_computeWorldVertices walks one vertex at a
+ * time. spSkinningMesh repacks them once, after loading, into groups of vertices with the same number of influences, stored
+ * as structures of arrays padded to whole blocks of 4 vertices. Each block is then skinned with SSE against a palette of the
+ * bones' world transforms, or with the scalar fallback where SSE is not available or SPINE_NO_SIMD is defined.
+ *
+ * The arithmetic is done in the same order as spSkinnedMeshAttachment_computeWorldVertices, so the world vertices are the
+ * same bit for bit.
+ */
+
+typedef struct spSkinningPalette {
+	const int bonesCount;
+	float* const transforms; /* Per bone m00, m01, m10, m11, worldX, worldY and 2 padding floats. */
+} spSkinningPalette;
+
+spSkinningPalette* spSkinningPalette_create (int bonesCount);
+void spSkinningPalette_dispose (spSkinningPalette* self);
+/* Copies the world transforms of the skeleton's bones, after spSkeleton_updateWorldTransform. */
+void spSkinningPalette_update (spSkinningPalette* self, const spSkeleton* skeleton);
+
+typedef struct spSkinningMesh {
+	const int worldVerticesCount; /* Floats written, x and y per vertex, as by the attachment. */
+	const int influencesCount;
+	const int paddedInfluencesCount; /* Including the padding of partial blocks, which is skinned and discarded. */
+} spSkinningMesh;
+
+/* The mesh keeps no reference to the attachment. */
+spSkinningMesh* spSkinningMesh_create (const spSkinnedMeshAttachment* attachment);
+void spSkinningMesh_dispose (spSkinningMesh* self);
+
+/* ffd is the slot's attachmentVertices when its attachmentVerticesCount is not 0, otherwise 0. */
+void spSkinningMesh_computeWorldVertices (const spSkinningMesh* self, const spSkinningPalette* palette, float x, float y,
+		const float* ffd, float* worldVertices);
+
+typedef struct spSkinningInstance {
+	const spSkinningPalette* palette;
+	float x, y; /* The skeleton's position. */
+	const float* ffd;
+	float* worldVertices;
+} spSkinningInstance;
+
+/* Skins the mesh for several skeletons sharing it, such as a crowd of the same character. Each chunk of the mesh is read
+ * once for all the instances instead of once per instance. */
+void spSkinningMesh_computeBatch (const spSkinningMesh* self, const spSkinningInstance* instances, int instancesCount);
+
+#ifdef SPINE_SHORT_NAMES
+typedef spSkinningPalette SkinningPalette;
+typedef spSkinningMesh SkinningMesh;
+typedef spSkinningInstance SkinningInstance;
+#define SkinningPalette_create(...) spSkinningPalette_create(__VA_ARGS__)
+#define SkinningPalette_dispose(...) spSkinningPalette_dispose(__VA_ARGS__)
+#define SkinningPalette_update(...) spSkinningPalette_update(__VA_ARGS__)
+#define SkinningMesh_create(...) spSkinningMesh_create(__VA_ARGS__)
+#define SkinningMesh_dispose(...) spSkinningMesh_dispose(__VA_ARGS__)
+#define SkinningMesh_computeWorldVertices(...) spSkinningMesh_computeWorldVertices(__VA_ARGS__)
+#define SkinningMesh_computeBatch(...) spSkinningMesh_computeBatch(__VA_ARGS__)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SPINE_SKINNING_H_ */
@@ -0,0 +1,40 @@
+#ifndef SPINE_THREAD_H_
+#define SPINE_THREAD_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Internal threading primitives over pthreads or Win32, for the runtime's worker threads. They are allocated with the system
+ * allocator, so they can be created and disposed under any allocator context.
+ */
+
+typedef struct _spThread _spThread;
+typedef struct _spMutex _spMutex;
+typedef struct _spCondition _spCondition;
+
+/* Starts a thread running run(userData). Returns 0 if the thread cannot be started. */
+_spThread* _spThread_create (void (*run) (void* userData), void* userData);
+/* Waits for run to return and frees the thread. */
+void _spThread_join (_spThread* self);
+/* Number of processors available, at least 1. */
+int _spThread_getProcessorsCount ();
+
+_spMutex* _spMutex_create ();
+void _spMutex_dispose (_spMutex* self);
+void _spMutex_lock (_spMutex* self);
+void _spMutex_unlock (_spMutex* self);
+
+_spCondition* _spCondition_create ();
+void _spCondition_dispose (_spCondition* self);
+/* Unlocks mutex, which must be locked, until woken. Wakeups can be spurious, so wait in a loop on the awaited state. */
+void _spCondition_wait (_spCondition* self, _spMutex* mutex);
+void _spCondition_signal (_spCondition* self);
+void _spCondition_broadcast (_spCondition* self);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SPINE_THREAD_H_ */
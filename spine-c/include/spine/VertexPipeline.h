@@ -0,0 +1,59 @@
+#ifndef SPINE_VERTEXPIPELINE_H_
+#define SPINE_VERTEXPIPELINE_H_
+
+#include <spine/Skeleton.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Computes the world vertices of a frame's skeletons on a pool of threads. spVertexPipeline_layout gives the region, mesh and
+ * skinned mesh attachment of every slot its place in one vertex buffer, and splits the work into jobs of about 500
+ * vertices: small attachments are grouped, large meshes are cut into ranges of vertices. spVertexPipeline_compute then runs
+ * the jobs on the pool and the calling thread, writing straight into the caller's buffer.
+ *
+ * The world vertices are those of spRegionAttachment_computeWorldVertices, spMeshAttachment_computeWorldVertices and
+ * spSkinnedMeshAttachment_computeWorldVertices, with the skeleton's x and y.
+ */
+
+typedef struct spVertexPipeline {
+	const int threadsCount;
+	const int skeletonsCount; /* Of the last layout. */
+	const int verticesCount; /* Floats of the last layout. */
+	const int jobsCount;
+} spVertexPipeline;
+
+/* threadsCount of 0 uses one thread per processor but one, as the calling thread also works. */
+spVertexPipeline* spVertexPipeline_create (int threadsCount);
+void spVertexPipeline_dispose (spVertexPipeline* self);
+
+/* Lays out the world vertices of the skeletons' attachments and returns the floats the vertex buffer needs. The skeletons'
+ * attachments must not change until the next layout, but the same layout can be computed again after their bones move. */
+int spVertexPipeline_layout (spVertexPipeline* self, spSkeleton* const* skeletons, int skeletonsCount);
+/* Per slot index of the skeleton, the offset of the slot's world vertices in the vertex buffer, or -1. */
+const int* spVertexPipeline_getOffsets (const spVertexPipeline* self, int skeletonIndex);
+
+/* Writes the world vertices of the last layout into vertices, which holds at least verticesCount floats, and returns once
+ * all are written. World transforms must be updated beforehand and not change until then. */
+void spVertexPipeline_compute (spVertexPipeline* self, float* vertices);
+
+/* Where skinned meshes are cut is kept per attachment across layouts. Clear it before disposing skeleton data the pipeline
+ * has laid out, if the pipeline is kept. */
+void spVertexPipeline_clearCache (spVertexPipeline* self);
+
+#ifdef SPINE_SHORT_NAMES
+typedef spVertexPipeline VertexPipeline;
+#define VertexPipeline_create(...) spVertexPipeline_create(__VA_ARGS__)
+#define VertexPipeline_dispose(...) spVertexPipeline_dispose(__VA_ARGS__)
+#define VertexPipeline_layout(...) spVertexPipeline_layout(__VA_ARGS__)
+#define VertexPipeline_getOffsets(...) spVertexPipeline_getOffsets(__VA_ARGS__)
+#define VertexPipeline_compute(...) spVertexPipeline_compute(__VA_ARGS__)
+#define VertexPipeline_clearCache(...) spVertexPipeline_clearCache(__VA_ARGS__)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SPINE_VERTEXPIPELINE_H_ */
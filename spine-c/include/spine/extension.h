@@ -36,6 +36,8 @@
 #define CALLOC(TYPE, COUNT) ((TYPE*)_spCalloc(COUNT, sizeof(TYPE), __FILE__, __LINE__))
 #define REALLOC(PTR, TYPE, COUNT) ((TYPE*)_spRealloc(PTR, sizeof(TYPE) * (COUNT)))
 #define NEW(TYPE) CALLOC(TYPE,1)
+/* ALIGNMENT is a power of two. The block is released with FREE like any other. */
+#define MALLOC_ALIGNED(TYPE, COUNT, ALIGNMENT) ((TYPE*)_spMallocAligned(sizeof(TYPE) * (COUNT), ALIGNMENT, __FILE__, __LINE__))
 
 /* Gets the direct super class. Type safe. */
 #define SUPER(VALUE) (&VALUE->super)
@@ -55,6 +57,9 @@
 /* Frees memory. Can be used on const types. */
 #define FREE(VALUE) _spFree((void*)VALUE)
 
+/* Frees memory whose size is known to the caller. COUNT must match the MALLOC or the last REALLOC of VALUE. */
+#define FREE_SIZED(VALUE, TYPE, COUNT) _spFreeSized((void*)VALUE, sizeof(TYPE) * (COUNT))
+
 /* Allocates a new char[], assigns it to TO, and copies FROM to it. Can be used on const types. */
 #define MALLOC_STR(TO,FROM) strcpy(CONST_CAST(char*, TO) = (char*)MALLOC(char, strlen(FROM) + 1), FROM)
 
@@ -62,6 +67,9 @@
 #define DEG_RAD (PI / 180)
 #define RAD_DEG (180 / PI)
 
+/* Alignment of float buffers the runtime may process with SIMD, such as mesh vertices and weights. */
+#define SP_FLOAT_ALIGNMENT 16
+
 #ifdef __STDC_VERSION__
 #define FMOD(A,B) fmodf(A, B)
 #define ATAN2(A,B) atan2f(A, B)
@@ -87,9 +95,17 @@
 
 #define UNUSED(x) (void)(x)
 
+#if defined(_MSC_VER)
+#define SP_THREAD_LOCAL __declspec(thread)
+#else
+#define SP_THREAD_LOCAL __thread
+#endif
+
 #include <stdlib.h>
+#include <stdio.h>
 #include <string.h>
 #include <math.h>
+#include <spine/Allocator.h>
 #include <spine/Skeleton.h>
 #include <spine/Animation.h>
 #include <spine/Atlas.h>
@@ -126,14 +142,66 @@ void* _spMalloc(size_t size, const char* file, int line);
 void* _spCalloc(size_t num, size_t size, const char* file, int line);
 void* _spRealloc(void* ptr, size_t size);
 void _spFree(void* ptr);
+void* _spMallocAligned(size_t size, size_t alignment, const char* file, int line);
+void _spFreeSized(void* ptr, size_t size);
 
+/* The hooks below make up the default allocator context, used while no spAllocator is current. See Allocator.h. */
 void _spSetMalloc(void* (*_malloc)(size_t size));
 void _spSetDebugMalloc(void* (*_malloc)(size_t size, const char* file, int line));
 void _spSetRealloc(void* (*_realloc)(void* ptr, size_t size));
 void _spSetFree(void (*_free)(void* ptr));
+/* Optional. Blocks returned by the aligned malloc must be accepted by the realloc and free set above. Without it, aligned
+ * blocks come from posix_memalign while the system allocator is in use, otherwise from the malloc set above with only its
+ * own alignment. */
+void _spSetMallocAligned(void* (*_mallocAligned)(size_t size, size_t alignment));
+/* Optional. Only called for blocks the runtime knows the size of, so the free set above must still accept every block. */
+void _spSetFreeSized(void (*_freeSized)(void* ptr, size_t size));
 
 char* _spReadFile(const char* path, int* length);
 
+/* Running totals of allocations and reallocations made on the calling thread, and of the bytes they requested. Kept only
+ * when the runtime is built with SPINE_BINARY_PROFILE, otherwise both are 0. */
+void _spAllocationCounts_get(size_t* allocations, size_t* bytes);
+
+/*
+ * Allocation statistics. Collected only when the runtime is built with SPINE_MEMORY_STATS defined, otherwise the getters
+ * report nothing and allocation carries no overhead. Each block is attributed to the MALLOC/CALLOC call site that created
+ * it; REALLOC keeps the original site.
+ */
+
+typedef enum {
+	SP_MEMORY_LOADER, /* SkeletonBinary, SkeletonJson, Atlas, skins and attachments. */
+	SP_MEMORY_BONES, /* Bones, slots and the skeleton. */
+	SP_MEMORY_TIMELINES, /* Animations, timelines, events and animation state. */
+	SP_MEMORY_ARRAYS, /* _SP_ARRAY instances from Array.c. */
+	SP_MEMORY_OTHER,
+	SP_MEMORY_SUBSYSTEMS_COUNT
+} spMemorySubsystem;
+
+typedef struct spMemoryStats {
+	size_t liveBytes;
+	size_t peakBytes;
+	size_t allocations;
+	size_t reallocations;
+	size_t frees;
+} spMemoryStats;
+
+typedef struct spMemorySiteStats {
+	const char* file; /* 0 for blocks first allocated through REALLOC. */
+	int line;
+	spMemorySubsystem subsystem;
+	spMemoryStats stats;
+} spMemorySiteStats;
+
+/* Returns 0 if statistics are compiled out. subsystems may be 0, otherwise it receives SP_MEMORY_SUBSYSTEMS_COUNT entries. */
+int _spMemoryStats_get(spMemoryStats* total, spMemoryStats* subsystems);
+/* Copies up to capacity call sites into sites and returns the number of call sites recorded. */
+int _spMemoryStats_getSites(spMemorySiteStats* sites, int capacity);
+/* Clears counters and sets peaks to the current live bytes. Live bytes are kept. */
+void _spMemoryStats_reset();
+/* Writes a tab separated report, one line per subsystem and per call site, sorted by live bytes. */
+void _spMemoryStats_report(FILE* file);
+
 /**/
 
 typedef struct _spAnimationState {
@@ -186,11 +254,49 @@ void _spAttachment_deinit (spAttachment* self);
 
 /**/
 
+/* Calls visit for every entry of the skin, newest first, the order in which spSkin_getAttachmentName lists a slot's names. */
+void _spSkin_forEachAttachment (const spSkin* self, void* userData,
+		void (*visit) (void* userData, int slotIndex, const char* name, spAttachment* attachment));
+
+/**/
+
+/* The geometry arrays of meshes and skinned meshes. Skinned meshes keep their weights in place of the vertices. */
+typedef enum {
+	SP_MESH_ARRAY_UVS,
+	SP_MESH_ARRAY_TRIANGLES,
+	SP_MESH_ARRAY_VERTICES,
+	SP_MESH_ARRAY_BONES,
+	SP_MESH_ARRAY_EDGES,
+	SP_MESH_ARRAYS_COUNT
+} _spMeshArray;
+
+/* Makes the attachment one of the *refs attachments sharing its array. Disposing it decrements the count, and only the last
+ * attachment frees the array and refs. The attachment must come from spMeshAttachment_create or
+ * spSkinnedMeshAttachment_create. */
+void _spMeshAttachment_shareArray (spMeshAttachment* self, _spMeshArray array, int* refs);
+void _spSkinnedMeshAttachment_shareArray (spSkinnedMeshAttachment* self, _spMeshArray array, int* refs);
+/* Frees array unless refs counts other attachments still using it. refs may be 0 for an array that is not shared. */
+void _spMeshArray_release (void* array, int* refs);
+/* Points the attachment's triangles at indices in the index pool block pool, making it one of the *refs holders of the block.
+ * Disposing it releases the block like a shared array. The attachment must come from spMeshAttachment_create or
+ * spSkinnedMeshAttachment_create. */
+void _spMeshAttachment_setPooledIndices (spMeshAttachment* self, const unsigned short* indices, void* pool, int* refs);
+void _spSkinnedMeshAttachment_setPooledIndices (spSkinnedMeshAttachment* self, const unsigned short* indices, void* pool,
+		int* refs);
+/* Returns the attachment's triangles in its index pool, or 0 if they were not read into one. */
+const unsigned short* _spMeshAttachment_getPooledIndices (const spMeshAttachment* self);
+const unsigned short* _spSkinnedMeshAttachment_getPooledIndices (const spSkinnedMeshAttachment* self);
+
+/**/
+
 void _spTimeline_init (spTimeline* self, spTimelineType type, /**/
 void (*dispose) (spTimeline* self), /**/
 		void (*apply) (const spTimeline* self, spSkeleton* skeleton, float lastTime, float time, spEvent** firedEvents,
 				int* eventsCount, float alpha));
 void _spTimeline_deinit (spTimeline* self);
+/* The search of Animation.c for timelines with one value per frame: the index of the first frame after target. values must
+ * hold at least 2 frames. For the timeline subtypes below, which apply outside Animation.c. */
+int _spTimeline_binarySearch1 (const float* values, int valuesLength, float target);
 
 #ifdef SPINE_SHORT_NAMES
 #define _Timeline_init(...) _spTimeline_init(__VA_ARGS__)
@@ -199,6 +305,45 @@ void _spTimeline_deinit (spTimeline* self);
 
 /**/
 
+/* An attachment timeline which is filled like any other, then resolved once the skins of skeletonData are read. Resolving
+ * gives frames with the same name one shared string and keeps, for each name, the default skin's attachment and those of the
+ * data's skins that have one in the slot. Applying it to a skeleton of that data sets the attachment found when resolving
+ * without looking the name up. Other skins, and skins without the name, fall back to spSkeleton_getAttachmentForSlotIndex.
+ * Skins must not gain or lose attachments after resolving. See ResolvedAttachmentTimeline.c. */
+spAttachmentTimeline* _spAttachmentTimeline_createResolved (int framesCount);
+void _spAttachmentTimeline_resolve (spAttachmentTimeline* self, const spSkeletonData* skeletonData);
+
+/* A draw order timeline that keeps each frame as the slots it moves instead of a full draw order, and expands the frame when
+ * applied. Its drawOrders is 0. A frame is a pair of a slot index and the offset of the slot's position from its setup pose
+ * index for each slot it moves, by ascending slot index. A frame without pairs is the setup pose order. The timeline holds
+ * pairsCount pairs in all. See CompactDrawOrderTimeline.c. */
+spDrawOrderTimeline* _spDrawOrderTimeline_createCompact (int framesCount, int slotsCount, int pairsCount);
+/* Copies the frame's pairs. Frames are set in order. Returns 0 if the pairs are out of order, move a slot outside
+ * the draw order or exceed the pairs the timeline was created with. */
+int _spDrawOrderTimeline_setFrameOffsets (spDrawOrderTimeline* self, int frameIndex, float time, const int* offsets,
+		int pairsCount);
+/* Writes the pairs of a frame of any draw order timeline to offsets, which holds 2 * slotsCount, and returns their count. */
+int _spDrawOrderTimeline_getOffsets (const spDrawOrderTimeline* self, int frameIndex, int* offsets);
+
+/* An event timeline whose events are one block rather than an allocation per frame. An event keeps its data's stringValue
+ * unless it has a string of its own, which is copied into one block of stringsLength chars, terminators included, shared by
+ * the frames. Applying it fires the same events as the upstream timeline. See SharedEventTimeline.c. */
+spEventTimeline* _spEventTimeline_createShared (int framesCount, int stringsLength);
+/* Sets the frame's event. A stringLength of -1 keeps the data's stringValue. Otherwise stringLength chars of stringValue are
+ * copied, or the event has no string if stringValue is 0. Frames are set in order. Returns 0 if the string exceeds the block. */
+int _spEventTimeline_setSharedFrame (spEventTimeline* self, int frameIndex, float time, spEventData* data, int intValue,
+		float floatValue, const char* stringValue, int stringLength);
+
+/**/
+
+/* The decoders of the binary reader, so they can be benchmarked without a load. data must hold what is decoded, which is not
+ * checked. Both return the bytes read. */
+int _spSkeletonBinary_readVarints (const unsigned char* data, int count, int /*bool*/ optimizePositive, int* values);
+/* Reads a varint size, then size floats multiplied by scale into values, which is allocated as the reader does. */
+int _spSkeletonBinary_readFloatArray (const unsigned char* data, float scale, float** values, int* size);
+
+/**/
+
 void _spCurveTimeline_init (spCurveTimeline* self, spTimelineType type, int framesCount, /**/
 void (*dispose) (spTimeline* self), /**/
 		void (*apply) (const spTimeline* self, spSkeleton* skeleton, float lastTime, float time, spEvent** firedEvents,
@@ -0,0 +1,133 @@
+#include <spine/Allocator.h>
+#include <spine/extension.h>
+
+/* Block and chunk headers are 16 and 32 bytes, which keeps every block 16 byte aligned. */
+#define BLOCK_HEADER_SIZE 16
+#define CHUNK_HEADER_SIZE 32
+#define DEFAULT_CHUNK_SIZE (64 * 1024)
+
+typedef struct _spArenaChunk {
+	struct _spArenaChunk* next;
+	size_t capacity;
+	size_t used;
+} _spArenaChunk;
+
+typedef struct {
+	spArena super;
+	size_t chunkSize;
+	_spArenaChunk* chunks; /* Blocks are carved from the first chunk. */
+	char* last; /* Most recent block of the first chunk, 0 once it is freed. */
+} _spArena;
+
+static char* getChunkData (_spArenaChunk* chunk) {
+	return (char*)chunk + CHUNK_HEADER_SIZE;
+}
+
+/* Large requests get a chunk of their own behind the first one, so the space left in the first chunk is not wasted. */
+static _spArenaChunk* _spArena_addChunk (_spArena* self, size_t need) {
+	int dedicated = need > self->chunkSize / 4;
+	size_t capacity = dedicated ? need : self->chunkSize - CHUNK_HEADER_SIZE;
+	_spArenaChunk* chunk = (_spArenaChunk*)malloc(CHUNK_HEADER_SIZE + capacity);
+	if (!chunk) return 0;
+	chunk->capacity = capacity;
+	chunk->used = 0;
+	if (dedicated && self->chunks) {
+		chunk->next = self->chunks->next;
+		self->chunks->next = chunk;
+	} else {
+		chunk->next = self->chunks;
+		self->chunks = chunk;
+		self->last = 0;
+	}
+	CONST_CAST(size_t, self->super.reservedBytes) += CHUNK_HEADER_SIZE + capacity;
+	return chunk;
+}
+
+static void _spArena_addLive (_spArena* self, size_t size) {
+	CONST_CAST(size_t, self->super.liveBytes) += size;
+	if (self->super.liveBytes > self->super.peakBytes) CONST_CAST(size_t, self->super.peakBytes) = self->super.liveBytes;
+}
+
+static void* _spArena_allocate (void* userData, size_t size, const char* file, int line) {
+	_spArena* self = (_spArena*)userData;
+	size_t need = BLOCK_HEADER_SIZE + ((size + 15) & ~(size_t)15);
+	_spArenaChunk* chunk = self->chunks;
+	char* block;
+	UNUSED(file);
+	UNUSED(line);
+
+	if (!chunk || chunk->capacity - chunk->used < need) {
+		chunk = _spArena_addChunk(self, need);
+		if (!chunk) return 0;
+	}
+	block = getChunkData(chunk) + chunk->used;
+	chunk->used += need;
+	if (chunk == self->chunks) self->last = block;
+	*(size_t*)block = size;
+
+	CONST_CAST(int, self->super.allocationsCount)++;
+	_spArena_addLive(self, size);
+	return block + BLOCK_HEADER_SIZE;
+}
+
+/* Only used to give back the most recent block when it moves. The arena is dispose-only, so FREE does not reach it. */
+static void _spArena_deallocate (void* userData, void* ptr) {
+	_spArena* self = (_spArena*)userData;
+	char* block;
+	if (!ptr) return;
+	block = (char*)ptr - BLOCK_HEADER_SIZE;
+	CONST_CAST(size_t, self->super.liveBytes) -= *(size_t*)block;
+	if (block == self->last) {
+		self->chunks->used = block - getChunkData(self->chunks);
+		self->last = 0;
+	}
+}
+
+static void* _spArena_reallocate (void* userData, void* ptr, size_t size) {
+	_spArena* self = (_spArena*)userData;
+	char* block;
+	size_t oldSize;
+	void* newPtr;
+	if (!ptr) return _spArena_allocate(userData, size, 0, 0);
+
+	block = (char*)ptr - BLOCK_HEADER_SIZE;
+	oldSize = *(size_t*)block;
+	if (block == self->last) {
+		size_t need = BLOCK_HEADER_SIZE + ((size + 15) & ~(size_t)15);
+		size_t offset = block - getChunkData(self->chunks);
+		if (self->chunks->capacity - offset >= need) {
+			self->chunks->used = offset + need;
+			*(size_t*)block = size;
+			CONST_CAST(size_t, self->super.liveBytes) -= oldSize;
+			_spArena_addLive(self, size);
+			return ptr;
+		}
+	}
+
+	newPtr = _spArena_allocate(userData, size, 0, 0);
+	if (!newPtr) return 0;
+	memcpy(newPtr, ptr, MIN(oldSize, size));
+	_spArena_deallocate(userData, ptr);
+	return newPtr;
+}
+
+spArena* spArena_create (size_t chunkSize) {
+	_spArena* self = (_spArena*)calloc(1, sizeof(_spArena));
+	if (!self) return 0;
+	self->chunkSize = chunkSize ? MAX(chunkSize, 1024) : DEFAULT_CHUNK_SIZE;
+	self->super.super.allocate = _spArena_allocate;
+	self->super.super.reallocate = _spArena_reallocate;
+	self->super.super.deallocate = 0;
+	self->super.super.userData = self;
+	return SUPER(self);
+}
+
+void spArena_dispose (spArena* self) {
+	_spArenaChunk* chunk = SUB_CAST(_spArena, self)->chunks;
+	while (chunk) {
+		_spArenaChunk* next = chunk->next;
+		free(chunk);
+		chunk = next;
+	}
+	free(self);
+}
@@ -0,0 +1,144 @@
+/******************************************************************************
+ * Spine Runtimes Software License
+ * Version 2.1
+ *
+ * Copyright (c) 2013, Esoteric Software
+ * All rights reserved.
+ *
+ * You are granted a perpetual, non-exclusive, non-sublicensable and
+ * non-transferable license to install, execute and perform the Spine Runtimes
+ * Software (the "Software") solely for internal use. Without the written
+ * permission of Esoteric Software (typically granted by licensing Spine), you
+ * may not (a) modify, translate, adapt or otherwise create derivative works,
+ * improvements of the Software or develop new applications using the Software
+ * or (b) remove, delete, alter or obscure any trademarks or any copyright,
+ * trademark, patent or other intellectual property or proprietary rights
+ * notices on or in the Software, including any copy thereof. Redistributions
+ * in binary or source form must include this license and terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ESOTERIC SOFTWARE "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL ESOTERIC SOFTARE BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+#include <spine/AtlasAttachmentLoader.h>
+#include <spine/AtlasIndex.h>
+#include <spine/extension.h>
+
+typedef struct {
+	spAtlasAttachmentLoader super;
+	const spAtlasIndex* index; /* Of super.atlas, built on first use unless given. */
+	spAtlasIndex* ownIndex;
+} _spAtlasAttachmentLoader;
+
+/* Finds the region through the index, building it again if the loader's atlas was changed. */
+static spAtlasRegion* _spAtlasAttachmentLoader_findRegion (_spAtlasAttachmentLoader* self, const char* path) {
+	if (!self->index || self->index->atlas != self->super.atlas) {
+		if (self->ownIndex) spAtlasIndex_dispose(self->ownIndex);
+		self->ownIndex = spAtlasIndex_create(self->super.atlas);
+		self->index = self->ownIndex;
+	}
+	return spAtlasIndex_findRegion(self->index, path);
+}
+
+static void _spAtlasAttachmentLoader_dispose (spAttachmentLoader* loader) {
+	_spAtlasAttachmentLoader* self = SUB_CAST(_spAtlasAttachmentLoader, loader);
+	if (self->ownIndex) spAtlasIndex_dispose(self->ownIndex);
+	_spAttachmentLoader_deinit(loader);
+}
+
+spAttachment* _spAtlasAttachmentLoader_newAttachment (spAttachmentLoader* loader, spSkin* skin, spAttachmentType type,
+		const char* name, const char* path) {
+	_spAtlasAttachmentLoader* self = SUB_CAST(_spAtlasAttachmentLoader, loader);
+	switch (type) {
+	case SP_ATTACHMENT_REGION: {
+		spRegionAttachment* attachment;
+		spAtlasRegion* region = _spAtlasAttachmentLoader_findRegion(self, path);
+		if (!region) {
+			_spAttachmentLoader_setError(loader, "Region not found: ", path);
+			return 0;
+		}
+		attachment = spRegionAttachment_create(name);
+		attachment->rendererObject = region;
+		spRegionAttachment_setUVs(attachment, region->u, region->v, region->u2, region->v2, region->rotate);
+		attachment->regionOffsetX = region->offsetX;
+		attachment->regionOffsetY = region->offsetY;
+		attachment->regionWidth = region->width;
+		attachment->regionHeight = region->height;
+		attachment->regionOriginalWidth = region->originalWidth;
+		attachment->regionOriginalHeight = region->originalHeight;
+		return SUPER(attachment);
+	}
+	case SP_ATTACHMENT_MESH: {
+		spMeshAttachment* attachment;
+		spAtlasRegion* region = _spAtlasAttachmentLoader_findRegion(self, path);
+		if (!region) {
+			_spAttachmentLoader_setError(loader, "Region not found: ", path);
+			return 0;
+		}
+		attachment = spMeshAttachment_create(name);
+		attachment->rendererObject = region;
+		attachment->regionU = region->u;
+		attachment->regionV = region->v;
+		attachment->regionU2 = region->u2;
+		attachment->regionV2 = region->v2;
+		attachment->regionRotate = region->rotate;
+		attachment->regionOffsetX = region->offsetX;
+		attachment->regionOffsetY = region->offsetY;
+		attachment->regionWidth = region->width;
+		attachment->regionHeight = region->height;
+		attachment->regionOriginalWidth = region->originalWidth;
+		attachment->regionOriginalHeight = region->originalHeight;
+		return SUPER(attachment);
+	}
+	case SP_ATTACHMENT_SKINNED_MESH: {
+		spSkinnedMeshAttachment* attachment;
+		spAtlasRegion* region = _spAtlasAttachmentLoader_findRegion(self, path);
+		if (!region) {
+			_spAttachmentLoader_setError(loader, "Region not found: ", path);
+			return 0;
+		}
+		attachment = spSkinnedMeshAttachment_create(name);
+		attachment->rendererObject = region;
+		attachment->regionU = region->u;
+		attachment->regionV = region->v;
+		attachment->regionU2 = region->u2;
+		attachment->regionV2 = region->v2;
+		attachment->regionRotate = region->rotate;
+		attachment->regionOffsetX = region->offsetX;
+		attachment->regionOffsetY = region->offsetY;
+		attachment->regionWidth = region->width;
+		attachment->regionHeight = region->height;
+		attachment->regionOriginalWidth = region->originalWidth;
+		attachment->regionOriginalHeight = region->originalHeight;
+		return SUPER(attachment);
+	}
+	case SP_ATTACHMENT_BOUNDING_BOX:
+		return SUPER(spBoundingBoxAttachment_create(name));
+	default:
+		_spAttachmentLoader_setUnknownTypeError(loader, type);
+		return 0;
+	}
+
+	UNUSED(skin);
+}
+
+spAtlasAttachmentLoader* spAtlasAttachmentLoader_create (spAtlas* atlas) {
+	_spAtlasAttachmentLoader* self = NEW(_spAtlasAttachmentLoader);
+	_spAttachmentLoader_init(SUPER(SUPER(self)), _spAtlasAttachmentLoader_dispose, _spAtlasAttachmentLoader_newAttachment);
+	self->super.atlas = atlas;
+	return SUPER(self);
+}
+
+spAtlasAttachmentLoader* spAtlasAttachmentLoader_createWithIndex (const spAtlasIndex* index) {
+	spAtlasAttachmentLoader* self = spAtlasAttachmentLoader_create((spAtlas*)index->atlas);
+	SUB_CAST(_spAtlasAttachmentLoader, self)->index = index;
+	return self;
+}
@@ -0,0 +1,68 @@
+#include <spine/AtlasIndex.h>
+#include <spine/extension.h>
+
+typedef struct {
+	spAtlasRegion* region; /* 0 for an empty slot. */
+	unsigned int hash;
+} _spAtlasIndexSlot;
+
+/* Open addressing over the regions, keyed on name. Capacity is a power of two, at most half full. */
+typedef struct {
+	spAtlasIndex super;
+	_spAtlasIndexSlot* slots;
+	unsigned int mask;
+} _spAtlasIndex;
+
+static unsigned int hashName (const char* name) {
+	/* FNV-1a, as the skin's attachment index. */
+	unsigned int hash = 2166136261u;
+	for (; *name; ++name) {
+		hash ^= (unsigned char)*name;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+spAtlasIndex* spAtlasIndex_create (const spAtlas* atlas) {
+	_spAtlasIndex* self = NEW(_spAtlasIndex);
+	spAtlasRegion* region;
+	int count = 0, capacity = 16;
+
+	for (region = atlas->regions; region; region = region->next)
+		++count;
+	while (capacity < count * 2)
+		capacity <<= 1;
+	self->slots = CALLOC(_spAtlasIndexSlot, capacity);
+	self->mask = (unsigned int)capacity - 1;
+
+	for (region = atlas->regions; region; region = region->next) {
+		unsigned int hash = hashName(region->name), i;
+		for (i = hash & self->mask; self->slots[i].region; i = (i + 1) & self->mask) {
+			const _spAtlasIndexSlot* slot = self->slots + i;
+			/* The first region with a name is kept, as spAtlas_findRegion finds it first. */
+			if (slot->hash == hash && strcmp(slot->region->name, region->name) == 0) break;
+		}
+		if (self->slots[i].region) continue;
+		self->slots[i].region = region;
+		self->slots[i].hash = hash;
+		++CONST_CAST(int, self->super.regionsCount);
+	}
+
+	CONST_CAST(const spAtlas*, self->super.atlas) = atlas;
+	return SUPER(self);
+}
+
+void spAtlasIndex_dispose (spAtlasIndex* self) {
+	FREE(SUB_CAST(_spAtlasIndex, self)->slots);
+	FREE(self);
+}
+
+spAtlasRegion* spAtlasIndex_findRegion (const spAtlasIndex* self, const char* name) {
+	const _spAtlasIndex* internal = SUB_CAST(_spAtlasIndex, self);
+	unsigned int hash = hashName(name), i;
+	for (i = hash & internal->mask; internal->slots[i].region; i = (i + 1) & internal->mask) {
+		const _spAtlasIndexSlot* slot = internal->slots + i;
+		if (slot->hash == hash && strcmp(slot->region->name, name) == 0) return slot->region;
+	}
+	return 0;
+}
@@ -0,0 +1,142 @@
+#include <spine/extension.h>
+
+/* A frame is the slots it moves, so a timeline costs 2 ints per moved slot rather than slotsCount ints per frame. */
+typedef struct {
+	spDrawOrderTimeline super;
+	int* frameStarts; /* framesCount + 1 pair indices. */
+	int* offsets; /* Slot index and offset pairs. */
+	int pairsCount; /* That offsets holds. */
+} _spCompactDrawOrderTimeline;
+
+/* Places the moved slots, then the others in setup pose order in the positions left, as the binary reader used to. */
+static void expandFrame (const _spCompactDrawOrderTimeline* self, int frameIndex, spSlot** slots, spSlot** drawOrder) {
+	const int* pair = self->offsets + self->frameStarts[frameIndex] * 2;
+	const int* end = self->offsets + self->frameStarts[frameIndex + 1] * 2;
+	int i, position = 0;
+	memset(drawOrder, 0, sizeof(spSlot*) * self->super.slotsCount);
+	for (; pair != end; pair += 2)
+		drawOrder[pair[0] + pair[1]] = slots[pair[0]];
+	pair = self->offsets + self->frameStarts[frameIndex] * 2;
+	for (i = 0; i < self->super.slotsCount; ++i) {
+		if (pair != end && pair[0] == i) {
+			pair += 2;
+			continue;
+		}
+		while (drawOrder[position]) ++position;
+		drawOrder[position++] = slots[i];
+	}
+}
+
+static void _spCompactDrawOrderTimeline_apply (const spTimeline* timeline, spSkeleton* skeleton, float lastTime, float time,
+		spEvent** firedEvents, int* eventsCount, float alpha) {
+	const _spCompactDrawOrderTimeline* self = SUB_CAST(const _spCompactDrawOrderTimeline, timeline);
+	const spDrawOrderTimeline* frames = SUPER(self);
+	int frameIndex;
+	UNUSED(lastTime);
+	UNUSED(firedEvents);
+	UNUSED(eventsCount);
+	UNUSED(alpha);
+
+	if (time < frames->frames[0]) return; /* Time is before first frame. */
+
+	if (time >= frames->frames[frames->framesCount - 1]) /* Time is after last frame. */
+		frameIndex = frames->framesCount - 1;
+	else
+		frameIndex = _spTimeline_binarySearch1(frames->frames, frames->framesCount, time) - 1;
+
+	if (self->frameStarts[frameIndex] == self->frameStarts[frameIndex + 1])
+		memcpy(skeleton->drawOrder, skeleton->slots, sizeof(spSlot*) * skeleton->slotsCount);
+	else
+		expandFrame(self, frameIndex, skeleton->slots, skeleton->drawOrder);
+}
+
+static void _spCompactDrawOrderTimeline_dispose (spTimeline* timeline) {
+	_spCompactDrawOrderTimeline* self = SUB_CAST(_spCompactDrawOrderTimeline, timeline);
+	_spTimeline_deinit(timeline);
+	FREE(self->super.frames);
+	FREE(self->frameStarts);
+	FREE(self->offsets);
+	FREE(self);
+}
+
+spDrawOrderTimeline* _spDrawOrderTimeline_createCompact (int framesCount, int slotsCount, int pairsCount) {
+	_spCompactDrawOrderTimeline* self = NEW(_spCompactDrawOrderTimeline);
+	_spTimeline_init(SUPER(SUPER(self)), SP_TIMELINE_DRAWORDER, _spCompactDrawOrderTimeline_dispose,
+			_spCompactDrawOrderTimeline_apply);
+	CONST_CAST(int, self->super.framesCount) = framesCount;
+	CONST_CAST(float*, self->super.frames) = CALLOC(float, framesCount);
+	CONST_CAST(int, self->super.slotsCount) = slotsCount;
+	self->frameStarts = CALLOC(int, framesCount + 1);
+	self->offsets = MALLOC(int, pairsCount * 2);
+	self->pairsCount = pairsCount;
+	return SUPER(self);
+}
+
+int _spDrawOrderTimeline_setFrameOffsets (spDrawOrderTimeline* timeline, int frameIndex, float time, const int* offsets,
+		int pairsCount) {
+	_spCompactDrawOrderTimeline* self = SUB_CAST(_spCompactDrawOrderTimeline, timeline);
+	int i, start = self->frameStarts[frameIndex], previous = -1;
+	if (pairsCount < 0 || pairsCount > self->pairsCount - start) return 0;
+	for (i = 0; i < pairsCount; ++i) {
+		int slotIndex = offsets[i * 2], position = slotIndex + offsets[i * 2 + 1];
+		if (slotIndex <= previous || slotIndex >= timeline->slotsCount || position < 0 || position >= timeline->slotsCount)
+			return 0;
+		previous = slotIndex;
+	}
+	timeline->frames[frameIndex] = time;
+	memcpy(self->offsets + start * 2, offsets, sizeof(int) * pairsCount * 2);
+	self->frameStarts[frameIndex + 1] = start + pairsCount;
+	return 1;
+}
+
+int _spDrawOrderTimeline_getOffsets (const spDrawOrderTimeline* self, int frameIndex, int* offsets) {
+	const int* drawOrder;
+	int i, count = 0;
+	if (!self->drawOrders) {
+		const _spCompactDrawOrderTimeline* compact = SUB_CAST(const _spCompactDrawOrderTimeline, self);
+		count = compact->frameStarts[frameIndex + 1] - compact->frameStarts[frameIndex];
+		memcpy(offsets, compact->offsets + compact->frameStarts[frameIndex] * 2, sizeof(int) * count * 2);
+		return count;
+	}
+	drawOrder = self->drawOrders[frameIndex];
+	if (!drawOrder) return 0;
+	/* The offset of each slot goes to its own pair first, then the slots that moved are packed to the front. */
+	for (i = 0; i < self->slotsCount; ++i)
+		offsets[drawOrder[i] * 2 + 1] = i - drawOrder[i];
+	for (i = 0; i < self->slotsCount; ++i) {
+		if (offsets[i * 2 + 1] == 0) continue;
+		offsets[count * 2 + 1] = offsets[i * 2 + 1];
+		offsets[count * 2] = i;
+		++count;
+	}
+	return count;
+}
+
+int spDrawOrderTimeline_getDrawOrder (const spDrawOrderTimeline* self, int frameIndex, int* drawOrder) {
+	const _spCompactDrawOrderTimeline* compact;
+	const int *pair, *end;
+	int i, position = 0;
+	if (self->drawOrders) {
+		if (!self->drawOrders[frameIndex]) return 0;
+		memcpy(drawOrder, self->drawOrders[frameIndex], sizeof(int) * self->slotsCount);
+		return 1;
+	}
+	compact = SUB_CAST(const _spCompactDrawOrderTimeline, self);
+	pair = compact->offsets + compact->frameStarts[frameIndex] * 2;
+	end = compact->offsets + compact->frameStarts[frameIndex + 1] * 2;
+	if (pair == end) return 0;
+	for (i = 0; i < self->slotsCount; ++i)
+		drawOrder[i] = -1;
+	for (; pair != end; pair += 2)
+		drawOrder[pair[0] + pair[1]] = pair[0];
+	pair = compact->offsets + compact->frameStarts[frameIndex] * 2;
+	for (i = 0; i < self->slotsCount; ++i) {
+		if (pair != end && pair[0] == i) {
+			pair += 2;
+			continue;
+		}
+		while (drawOrder[position] != -1) ++position;
+		drawOrder[position++] = i;
+	}
+	return 1;
+}
@@ -0,0 +1,117 @@
+/******************************************************************************
+ * Spine Runtimes Software License
+ * Version 2.1
+ *
+ * Copyright (c) 2013, Esoteric Software
+ * All rights reserved.
+ *
+ * You are granted a perpetual, non-exclusive, non-sublicensable and
+ * non-transferable license to install, execute and perform the Spine Runtimes
+ * Software (the "Software") solely for internal use. Without the written
+ * permission of Esoteric Software (typically granted by licensing Spine), you
+ * may not (a) modify, translate, adapt or otherwise create derivative works,
+ * improvements of the Software or develop new applications using the Software
+ * or (b) remove, delete, alter or obscure any trademarks or any copyright,
+ * trademark, patent or other intellectual property or proprietary rights
+ * notices on or in the Software, including any copy thereof. Redistributions
+ * in binary or source form must include this license and terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ESOTERIC SOFTWARE "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL ESOTERIC SOFTARE BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+#include <spine/MeshAttachment.h>
+#include <spine/extension.h>
+
+typedef struct {
+	spMeshAttachment super;
+	int* refs[SP_MESH_ARRAYS_COUNT]; /* Attachments using each array, 0 for arrays the attachment owns alone. */
+	const unsigned short* pooledIndices; /* In indexPool, 0 unless the triangles were read into an index pool. */
+	void* indexPool;
+	int* indexPoolRefs;
+} _spMeshAttachment;
+
+void _spMeshArray_release (void* array, int* refs) {
+	if (refs) {
+		if (--*refs > 0) return;
+		FREE(refs);
+	}
+	FREE(array);
+}
+
+void _spMeshAttachment_dispose (spAttachment* attachment) {
+	_spMeshAttachment* self = SUB_CAST(_spMeshAttachment, attachment);
+	_spAttachment_deinit(attachment);
+	FREE(self->super.path);
+	FREE(self->super.uvs);
+	_spMeshArray_release(self->super.vertices, self->refs[SP_MESH_ARRAY_VERTICES]);
+	_spMeshArray_release(self->super.regionUVs, self->refs[SP_MESH_ARRAY_UVS]);
+	_spMeshArray_release(self->super.triangles, self->refs[SP_MESH_ARRAY_TRIANGLES]);
+	_spMeshArray_release(self->super.edges, self->refs[SP_MESH_ARRAY_EDGES]);
+	_spMeshArray_release(self->indexPool, self->indexPoolRefs);
+}
+
+spMeshAttachment* spMeshAttachment_create (const char* name) {
+	_spMeshAttachment* self = NEW(_spMeshAttachment);
+	self->super.r = 1;
+	self->super.g = 1;
+	self->super.b = 1;
+	self->super.a = 1;
+	_spAttachment_init(SUPER(SUPER(self)), name, SP_ATTACHMENT_MESH, _spMeshAttachment_dispose);
+	return SUPER(self);
+}
+
+void _spMeshAttachment_shareArray (spMeshAttachment* self, _spMeshArray array, int* refs) {
+	SUB_CAST(_spMeshAttachment, self)->refs[array] = refs;
+}
+
+void _spMeshAttachment_setPooledIndices (spMeshAttachment* self, const unsigned short* indices, void* pool, int* refs) {
+	_spMeshAttachment* internal = SUB_CAST(_spMeshAttachment, self);
+	internal->pooledIndices = indices;
+	internal->indexPool = pool;
+	internal->indexPoolRefs = refs;
+}
+
+const unsigned short* _spMeshAttachment_getPooledIndices (const spMeshAttachment* self) {
+	return SUB_CAST(const _spMeshAttachment, self)->pooledIndices;
+}
+
+void spMeshAttachment_updateUVs (spMeshAttachment* self) {
+	int i;
+	float width = self->regionU2 - self->regionU, height = self->regionV2 - self->regionV;
+	FREE(self->uvs);
+	self->uvs = MALLOC(float, self->verticesCount);
+	if (self->regionRotate) {
+		for (i = 0; i < self->verticesCount; i += 2) {
+			self->uvs[i] = self->regionU + self->regionUVs[i + 1] * width;
+			self->uvs[i + 1] = self->regionV + height - self->regionUVs[i] * height;
+		}
+	} else {
+		for (i = 0; i < self->verticesCount; i += 2) {
+			self->uvs[i] = self->regionU + self->regionUVs[i] * width;
+			self->uvs[i + 1] = self->regionV + self->regionUVs[i + 1] * height;
+		}
+	}
+}
+
+void spMeshAttachment_computeWorldVertices (spMeshAttachment* self, float x, float y, spSlot* slot, float* worldVertices) {
+	int i;
+	float* vertices = self->vertices;
+	const spBone* bone = slot->bone;
+	x += bone->worldX;
+	y += bone->worldY;
+	if (slot->attachmentVerticesCount == self->verticesCount) vertices = slot->attachmentVertices;
+	for (i = 0; i < self->verticesCount; i += 2) {
+		const float vx = vertices[i], vy = vertices[i + 1];
+		worldVertices[i] = vx * bone->m00 + vy * bone->m01 + x;
+		worldVertices[i + 1] = vx * bone->m10 + vy * bone->m11 + y;
+	}
+}
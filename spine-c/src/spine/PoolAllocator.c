@@ -0,0 +1,188 @@
+#include <spine/PoolAllocator.h>
+#include <spine/extension.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/* Every block starts with a 16 byte header, which keeps the payload malloc aligned. */
+#define HEADER_SIZE 16
+#define CLASSES_COUNT 10
+#define MAX_POOLED_SIZE 512
+#define CHUNK_SIZE (64 * 1024)
+#define LARGE_CLASS -1
+
+static const int classSizes[CLASSES_COUNT] = {16, 32, 48, 64, 96, 128, 192, 256, 384, 512};
+
+typedef struct _spPoolCache _spPoolCache;
+
+typedef struct {
+	union {
+		_spPoolCache* owner; /* Pooled blocks. */
+		size_t size; /* Large blocks, the requested size. */
+	} u;
+	int sizeClass; /* LARGE_CLASS for large blocks. */
+} _spPoolHeader;
+
+/* Free blocks are linked through the first word of their payload. */
+typedef struct _spPoolBlock {
+	struct _spPoolBlock* next;
+} _spPoolBlock;
+
+struct _spPoolCache {
+	_spPoolBlock* freeLists[CLASSES_COUNT];
+	_spPoolBlock* remoteFrees; /* Pushed by other threads, taken all at once by the owner. */
+};
+
+static SP_THREAD_LOCAL _spPoolCache* threadCache;
+
+/* Maps (size + 15) / 16 to a size class. */
+static int getSizeClass (size_t size) {
+	static const signed char classes[MAX_POOLED_SIZE / 16 + 1] = {
+		0, 0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7,
+		8, 8, 8, 8, 8, 8, 8, 8, 9, 9, 9, 9, 9, 9, 9, 9
+	};
+	return classes[(size + 15) >> 4];
+}
+
+static _spPoolHeader* getHeader (void* ptr) {
+	return (_spPoolHeader*)((char*)ptr - HEADER_SIZE);
+}
+
+static _spPoolCache* getCache () {
+	if (!threadCache) threadCache = (_spPoolCache*)calloc(1, sizeof(_spPoolCache));
+	return threadCache;
+}
+
+/* Lock-free push onto another thread's cache. Only the owner takes from the list, and it takes everything at once, so
+ * the push cannot suffer from ABA. */
+static void pushRemoteFree (_spPoolCache* owner, _spPoolBlock* block) {
+#if defined(_MSC_VER)
+	_spPoolBlock* head;
+	do {
+		head = owner->remoteFrees;
+		block->next = head;
+	} while (_InterlockedCompareExchangePointer((void* volatile*)&owner->remoteFrees, block, head) != head);
+#else
+	_spPoolBlock* head = __atomic_load_n(&owner->remoteFrees, __ATOMIC_RELAXED);
+	do {
+		block->next = head;
+	} while (!__atomic_compare_exchange_n(&owner->remoteFrees, &head, block, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+#endif
+}
+
+static _spPoolBlock* takeRemoteFrees (_spPoolCache* cache) {
+#if defined(_MSC_VER)
+	return (_spPoolBlock*)_InterlockedExchangePointer((void* volatile*)&cache->remoteFrees, 0);
+#else
+	return __atomic_exchange_n(&cache->remoteFrees, (_spPoolBlock*)0, __ATOMIC_ACQUIRE);
+#endif
+}
+
+/* Moves blocks freed by other threads onto the local free lists. */
+static void drainRemoteFrees (_spPoolCache* cache) {
+	_spPoolBlock* block = takeRemoteFrees(cache);
+	while (block) {
+		_spPoolBlock* next = block->next;
+		int sizeClass = getHeader(block)->sizeClass;
+		block->next = cache->freeLists[sizeClass];
+		cache->freeLists[sizeClass] = block;
+		block = next;
+	}
+}
+
+/* Carves a new chunk into blocks of one size class. Returns 0 if the system is out of memory. */
+static int refill (_spPoolCache* cache, int sizeClass) {
+	int stride = HEADER_SIZE + classSizes[sizeClass];
+	int i, count = CHUNK_SIZE / stride;
+	char* chunk = (char*)malloc(CHUNK_SIZE);
+	if (!chunk) return 0;
+	for (i = count - 1; i >= 0; --i) {
+		_spPoolHeader* header = (_spPoolHeader*)(chunk + i * stride);
+		_spPoolBlock* block = (_spPoolBlock*)((char*)header + HEADER_SIZE);
+		header->u.owner = cache;
+		header->sizeClass = sizeClass;
+		block->next = cache->freeLists[sizeClass];
+		cache->freeLists[sizeClass] = block;
+	}
+	return 1;
+}
+
+void* spPoolAllocator_malloc (size_t size) {
+	_spPoolCache* cache;
+	_spPoolBlock* block;
+	int sizeClass;
+
+	if (size > MAX_POOLED_SIZE) {
+		_spPoolHeader* header = (_spPoolHeader*)malloc(HEADER_SIZE + size);
+		if (!header) return 0;
+		header->u.size = size;
+		header->sizeClass = LARGE_CLASS;
+		return (char*)header + HEADER_SIZE;
+	}
+
+	cache = getCache();
+	if (!cache) return 0;
+	sizeClass = getSizeClass(size);
+	if (!cache->freeLists[sizeClass]) {
+		drainRemoteFrees(cache);
+		if (!cache->freeLists[sizeClass] && !refill(cache, sizeClass)) return 0;
+	}
+	block = cache->freeLists[sizeClass];
+	cache->freeLists[sizeClass] = block->next;
+	return block;
+}
+
+void spPoolAllocator_free (void* ptr) {
+	_spPoolHeader* header;
+	_spPoolBlock* block = (_spPoolBlock*)ptr;
+	_spPoolCache* owner;
+	if (!ptr) return;
+
+	header = getHeader(ptr);
+	if (header->sizeClass == LARGE_CLASS) {
+		free(header);
+		return;
+	}
+
+	owner = header->u.owner;
+	if (owner == threadCache) {
+		block->next = owner->freeLists[header->sizeClass];
+		owner->freeLists[header->sizeClass] = block;
+	} else
+		pushRemoteFree(owner, block);
+}
+
+void* spPoolAllocator_realloc (void* ptr, size_t size) {
+	_spPoolHeader* header;
+	size_t capacity;
+	void* newPtr;
+	if (!ptr) return spPoolAllocator_malloc(size);
+
+	header = getHeader(ptr);
+	if (header->sizeClass == LARGE_CLASS) {
+		if (size > MAX_POOLED_SIZE) {
+			header = (_spPoolHeader*)realloc(header, HEADER_SIZE + size);
+			if (!header) return 0;
+			header->u.size = size;
+			return (char*)header + HEADER_SIZE;
+		}
+		capacity = header->u.size;
+	} else {
+		capacity = (size_t)classSizes[header->sizeClass];
+		if (size <= capacity) return ptr;
+	}
+
+	newPtr = spPoolAllocator_malloc(size);
+	if (!newPtr) return 0;
+	memcpy(newPtr, ptr, MIN(capacity, size));
+	spPoolAllocator_free(ptr);
+	return newPtr;
+}
+
+void spPoolAllocator_install () {
+	_spSetDebugMalloc(0);
+	_spSetMalloc(spPoolAllocator_malloc);
+	_spSetRealloc(spPoolAllocator_realloc);
+	_spSetFree(spPoolAllocator_free);
+}
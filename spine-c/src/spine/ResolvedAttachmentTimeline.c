@@ -0,0 +1,150 @@
+#include <spine/extension.h>
+#include <limits.h>
+
+typedef struct {
+	const spSkin* skin;
+	spAttachment* attachment;
+} _spSkinAttachment;
+
+/* Frames with the same name share one string. Each distinct name holds the attachment of the default skin and, for each skin
+ * of the skeleton data that has an attachment of that name in the slot, the skin's attachment. The arrays are one block. */
+typedef struct {
+	spAttachmentTimeline super;
+	const spSkeletonData* skeletonData; /* 0 until resolved. */
+	int namesCount;
+	_spSkinAttachment* skinAttachments; /* Start of the block. */
+	char** names;
+	spAttachment** defaults;
+	int* frameNames; /* Index in names of each frame's name, -1 for none. */
+	int* nameStarts; /* namesCount + 1 indices in skinAttachments. */
+} _spResolvedAttachmentTimeline;
+
+/* Returns the attachment resolved for the name in the skeleton's skin. A skin without one, a skin created at runtime or
+ * another skeleton data looks the name up as the upstream timeline does. */
+static spAttachment* getAttachment (const _spResolvedAttachmentTimeline* self, const spSkeleton* skeleton, int frameIndex) {
+	int nameIndex = self->frameNames[frameIndex], i;
+	if (skeleton->data == self->skeletonData) {
+		if (!skeleton->skin) return self->defaults[nameIndex];
+		for (i = self->nameStarts[nameIndex]; i < self->nameStarts[nameIndex + 1]; ++i)
+			if (self->skinAttachments[i].skin == skeleton->skin) return self->skinAttachments[i].attachment;
+	}
+	return spSkeleton_getAttachmentForSlotIndex(skeleton, self->super.slotIndex, self->super.attachmentNames[frameIndex]);
+}
+
+static void _spResolvedAttachmentTimeline_apply (const spTimeline* timeline, spSkeleton* skeleton, float lastTime, float time,
+		spEvent** firedEvents, int* eventsCount, float alpha) {
+	const _spResolvedAttachmentTimeline* self = SUB_CAST(const _spResolvedAttachmentTimeline, timeline);
+	const spAttachmentTimeline* frames = SUPER(self);
+	spAttachment* attachment = 0;
+	int frameIndex;
+	UNUSED(firedEvents);
+	UNUSED(eventsCount);
+	UNUSED(alpha);
+
+	if (time < frames->frames[0]) {
+		if (lastTime > time) _spResolvedAttachmentTimeline_apply(timeline, skeleton, lastTime, (float)INT_MAX, 0, 0, 0);
+		return;
+	} else if (lastTime > time) /**/
+		lastTime = -1;
+
+	frameIndex = time >= frames->frames[frames->framesCount - 1] ?
+		frames->framesCount - 1 : _spTimeline_binarySearch1(frames->frames, frames->framesCount, time) - 1;
+	if (frames->frames[frameIndex] < lastTime) return;
+
+	if (frames->attachmentNames[frameIndex]) attachment = getAttachment(self, skeleton, frameIndex);
+	spSlot_setAttachment(skeleton->slots[frames->slotIndex], attachment);
+}
+
+static void _spResolvedAttachmentTimeline_dispose (spTimeline* timeline) {
+	_spResolvedAttachmentTimeline* self = SUB_CAST(_spResolvedAttachmentTimeline, timeline);
+	int i;
+	_spTimeline_deinit(timeline);
+	if (self->skeletonData) {
+		for (i = 0; i < self->namesCount; ++i)
+			FREE(self->names[i]);
+	} else {
+		for (i = 0; i < self->super.framesCount; ++i)
+			FREE(self->super.attachmentNames[i]);
+	}
+	FREE(self->super.attachmentNames);
+	FREE(self->super.frames);
+	FREE(self->skinAttachments);
+	FREE(self);
+}
+
+spAttachmentTimeline* _spAttachmentTimeline_createResolved (int framesCount) {
+	_spResolvedAttachmentTimeline* self = NEW(_spResolvedAttachmentTimeline);
+	_spTimeline_init(SUPER(SUPER(self)), SP_TIMELINE_ATTACHMENT, _spResolvedAttachmentTimeline_dispose,
+			_spResolvedAttachmentTimeline_apply);
+	CONST_CAST(int, self->super.framesCount) = framesCount;
+	CONST_CAST(float*, self->super.frames) = CALLOC(float, framesCount);
+	CONST_CAST(char**, self->super.attachmentNames) = CALLOC(char*, framesCount);
+	return SUPER(self);
+}
+
+/* Returns the first frame with the same name as the frame, which is the frame itself for the first occurrence. */
+static int firstFrame (const spAttachmentTimeline* timeline, int frameIndex) {
+	const char* name = timeline->attachmentNames[frameIndex];
+	int i;
+	for (i = 0; i < frameIndex; ++i)
+		if (timeline->attachmentNames[i] && strcmp(timeline->attachmentNames[i], name) == 0) return i;
+	return frameIndex;
+}
+
+static int countSkins (const spSkeletonData* skeletonData, int slotIndex, const char* name) {
+	int i, count = 0;
+	for (i = 0; i < skeletonData->skinsCount; ++i)
+		if (spSkin_getAttachment(skeletonData->skins[i], slotIndex, name)) ++count;
+	return count;
+}
+
+void _spAttachmentTimeline_resolve (spAttachmentTimeline* timeline, const spSkeletonData* skeletonData) {
+	_spResolvedAttachmentTimeline* self = SUB_CAST(_spResolvedAttachmentTimeline, timeline);
+	int i, ii, namesCount = 0, count = 0;
+	char* block;
+
+	for (i = 0; i < timeline->framesCount; ++i) {
+		if (!timeline->attachmentNames[i] || firstFrame(timeline, i) != i) continue;
+		++namesCount;
+		count += countSkins(skeletonData, timeline->slotIndex, timeline->attachmentNames[i]);
+	}
+
+	/* Pointer arrays first, so the int arrays after them are aligned. */
+	block = MALLOC(char, sizeof(_spSkinAttachment) * count + sizeof(void*) * 2 * namesCount
+			+ sizeof(int) * (timeline->framesCount + namesCount + 1));
+	self->skeletonData = skeletonData;
+	self->skinAttachments = (_spSkinAttachment*)block;
+	self->names = (char**)(self->skinAttachments + count);
+	self->defaults = (spAttachment**)(self->names + namesCount);
+	self->frameNames = (int*)(self->defaults + namesCount);
+	self->nameStarts = self->frameNames + timeline->framesCount;
+
+	count = 0;
+	for (i = 0; i < timeline->framesCount; ++i) {
+		char* name = (char*)timeline->attachmentNames[i];
+		int first;
+		self->frameNames[i] = -1;
+		if (!name) continue;
+		first = firstFrame(timeline, i);
+		if (first != i) {
+			FREE(name);
+			timeline->attachmentNames[i] = timeline->attachmentNames[first];
+			self->frameNames[i] = self->frameNames[first];
+			continue;
+		}
+		self->frameNames[i] = self->namesCount;
+		self->names[self->namesCount] = name;
+		self->defaults[self->namesCount] = skeletonData->defaultSkin ?
+			spSkin_getAttachment(skeletonData->defaultSkin, timeline->slotIndex, name) : 0;
+		self->nameStarts[self->namesCount] = count;
+		for (ii = 0; ii < skeletonData->skinsCount; ++ii) {
+			spAttachment* attachment = spSkin_getAttachment(skeletonData->skins[ii], timeline->slotIndex, name);
+			if (!attachment) continue;
+			self->skinAttachments[count].skin = skeletonData->skins[ii];
+			self->skinAttachments[count].attachment = attachment;
+			++count;
+		}
+		++self->namesCount;
+	}
+	self->nameStarts[self->namesCount] = count;
+}
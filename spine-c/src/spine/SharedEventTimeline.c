@@ -0,0 +1,87 @@
+#include <spine/extension.h>
+#include <limits.h>
+
+/* The events of all frames are one block. An event without a string of its own points at its data's stringValue, and the
+ * strings of the others are packed in one block, so a frame costs no allocation of its own. */
+typedef struct {
+	spEventTimeline super;
+	spEvent* events;
+	char* strings;
+	int stringsLength, stringsUsed;
+} _spSharedEventTimeline;
+
+static void _spSharedEventTimeline_apply (const spTimeline* timeline, spSkeleton* skeleton, float lastTime, float time,
+		spEvent** firedEvents, int* eventsCount, float alpha) {
+	const spEventTimeline* self = SUB_CAST(const spEventTimeline, timeline);
+	int frameIndex;
+	if (!firedEvents) return;
+
+	if (lastTime > time) { /* Fire events after last time for looped animations. */
+		_spSharedEventTimeline_apply(timeline, skeleton, lastTime, (float)INT_MAX, firedEvents, eventsCount, alpha);
+		lastTime = -1;
+	} else if (lastTime >= self->frames[self->framesCount - 1]) /* Last time is after last frame. */
+		return;
+	if (time < self->frames[0]) return; /* Time is before first frame. */
+
+	if (lastTime < self->frames[0])
+		frameIndex = 0;
+	else {
+		float frame;
+		frameIndex = _spTimeline_binarySearch1(self->frames, self->framesCount, lastTime);
+		frame = self->frames[frameIndex];
+		while (frameIndex > 0) { /* Fire multiple events with the same frame. */
+			if (self->frames[frameIndex - 1] != frame) break;
+			frameIndex--;
+		}
+	}
+	for (; frameIndex < self->framesCount && time >= self->frames[frameIndex]; ++frameIndex) {
+		firedEvents[*eventsCount] = self->events[frameIndex];
+		(*eventsCount)++;
+	}
+}
+
+static void _spSharedEventTimeline_dispose (spTimeline* timeline) {
+	_spSharedEventTimeline* self = SUB_CAST(_spSharedEventTimeline, timeline);
+	_spTimeline_deinit(timeline);
+	FREE(self->super.frames);
+	FREE(self->super.events);
+	FREE(self->events);
+	FREE(self->strings);
+	FREE(self);
+}
+
+spEventTimeline* _spEventTimeline_createShared (int framesCount, int stringsLength) {
+	_spSharedEventTimeline* self = NEW(_spSharedEventTimeline);
+	_spTimeline_init(SUPER(SUPER(self)), SP_TIMELINE_EVENT, _spSharedEventTimeline_dispose, _spSharedEventTimeline_apply);
+	CONST_CAST(int, self->super.framesCount) = framesCount;
+	CONST_CAST(float*, self->super.frames) = CALLOC(float, framesCount);
+	CONST_CAST(spEvent**, self->super.events) = CALLOC(spEvent*, framesCount);
+	self->events = CALLOC(spEvent, framesCount);
+	self->strings = stringsLength > 0 ? MALLOC(char, stringsLength) : 0;
+	self->stringsLength = stringsLength;
+	return SUPER(self);
+}
+
+int _spEventTimeline_setSharedFrame (spEventTimeline* timeline, int frameIndex, float time, spEventData* data, int intValue,
+		float floatValue, const char* stringValue, int stringLength) {
+	_spSharedEventTimeline* self = SUB_CAST(_spSharedEventTimeline, timeline);
+	spEvent* event = self->events + frameIndex;
+	CONST_CAST(spEventData*, event->data) = data;
+	event->intValue = intValue;
+	event->floatValue = floatValue;
+	if (stringLength < 0)
+		event->stringValue = data->stringValue;
+	else if (stringValue) {
+		char* string;
+		if (stringLength >= self->stringsLength - self->stringsUsed) return 0;
+		string = self->strings + self->stringsUsed;
+		memcpy(string, stringValue, stringLength);
+		string[stringLength] = 0;
+		self->stringsUsed += stringLength + 1;
+		event->stringValue = string;
+	} else
+		event->stringValue = 0;
+	timeline->frames[frameIndex] = time;
+	timeline->events[frameIndex] = event;
+	return 1;
+}
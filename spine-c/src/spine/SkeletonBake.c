@@ -0,0 +1,977 @@
+﻿#include <spine/SkeletonBake.h>
+#include <spine/extension.h>
+#include <stdint.h>
+
+/*
+ * An image is a header followed by the bones, IK constraints, slots, skins, events and animations, each item as 32 bit ints
+ * and floats in native byte order. Strings are a length counting the terminator, 0 for none, then the characters. Arrays
+ * are a count, -1 for none, then the items. Everything is padded to 4 bytes so arrays can be copied straight from the image.
+ */
+
+#define BAKE_MAGIC 0x4B425053 /* "SPBK" in little endian, so a byte swapped image fails the check. */
+#define CURVE_SIZE 19 /* BEZIER_SIZE in Animation.c, floats per sampled curve. */
+
+static int getPadded (int size) {
+	return (size + 3) & ~3;
+}
+
+/* Index of item in items, or -1. */
+static int findPointer (void* const* items, int count, const void* item) {
+	int i;
+	for (i = 0; i < count; ++i)
+		if (items[i] == item) return i;
+	return -1;
+}
+
+/*====================  Writing  ====================*/
+
+typedef struct {
+	const char* name;
+	spAttachment* attachment;
+} _spBakeSkinEntry;
+
+/* A skin's entries grouped by slot, newest first within a slot as spSkin_getAttachmentName lists them, so that writing the
+ * skin and finding the attachment of an FFD timeline do not walk every entry of the skin for each entry. */
+typedef struct {
+	_spBakeSkinEntry* entries;
+	int* slotStarts; /* slotsCount + 1 indices in entries. */
+	int* cursors; /* Next index in entries for each slot, while grouping. */
+	int slotsCount;
+} _spBakeSkin;
+
+typedef struct {
+	unsigned char* data;
+	int length, capacity;
+	_spBakeSkin* skins; /* One for each skin of the skeleton data. */
+	int failed;
+} _spBakeOutput;
+
+static void countSkinEntry (void* userData, int slotIndex, const char* name, spAttachment* attachment) {
+	_spBakeSkin* self = (_spBakeSkin*)userData;
+	UNUSED(name);
+	UNUSED(attachment);
+	if (slotIndex >= 0 && slotIndex < self->slotsCount) ++self->slotStarts[slotIndex + 1];
+}
+
+static void placeSkinEntry (void* userData, int slotIndex, const char* name, spAttachment* attachment) {
+	_spBakeSkin* self = (_spBakeSkin*)userData;
+	_spBakeSkinEntry* entry;
+	if (slotIndex < 0 || slotIndex >= self->slotsCount) return;
+	entry = self->entries + self->cursors[slotIndex]++;
+	entry->name = name;
+	entry->attachment = attachment;
+}
+
+/* A stable counting sort of the skin's entries by slot. */
+static void groupSkin (_spBakeSkin* self, const spSkin* skin, int slotsCount) {
+	int i;
+	self->slotsCount = slotsCount;
+	self->slotStarts = CALLOC(int, slotsCount + 1);
+	_spSkin_forEachAttachment(skin, self, countSkinEntry);
+	for (i = 0; i < slotsCount; ++i)
+		self->slotStarts[i + 1] += self->slotStarts[i];
+	self->entries = MALLOC(_spBakeSkinEntry, self->slotStarts[slotsCount]);
+	self->cursors = MALLOC(int, slotsCount);
+	memcpy(self->cursors, self->slotStarts, sizeof(int) * slotsCount);
+	_spSkin_forEachAttachment(skin, self, placeSkinEntry);
+	FREE(self->cursors);
+}
+
+static void writeBytes (_spBakeOutput* output, const void* bytes, int size) {
+	int padded = getPadded(size);
+	if (output->length + padded > output->capacity) {
+		output->capacity = MAX(output->capacity * 2, output->length + padded);
+		output->data = REALLOC(output->data, unsigned char, output->capacity);
+	}
+	if (size > 0) memcpy(output->data + output->length, bytes, size);
+	memset(output->data + output->length + size, 0, padded - size);
+	output->length += padded;
+}
+
+static void writeInt (_spBakeOutput* output, int value) {
+	writeBytes(output, &value, 4);
+}
+
+static void writeFloat (_spBakeOutput* output, float value) {
+	writeBytes(output, &value, 4);
+}
+
+static void writeString (_spBakeOutput* output, const char* value) {
+	int length = value ? (int)strlen(value) + 1 : 0;
+	writeInt(output, length);
+	writeBytes(output, value, length);
+}
+
+static void writeFloats (_spBakeOutput* output, const float* values, int count) {
+	writeInt(output, values ? count : -1);
+	if (values) writeBytes(output, values, count * 4);
+}
+
+static void writeInts (_spBakeOutput* output, const int* values, int count) {
+	writeInt(output, values ? count : -1);
+	if (values) writeBytes(output, values, count * 4);
+}
+
+/* Writes a mesh's triangles like writeInts, taking them from its index pool if the mesh's indices were pooled. */
+static void writeTriangles (_spBakeOutput* output, const spAttachment* attachment, const int* triangles, int count) {
+	const unsigned short* indices;
+	int i;
+	if (triangles || count == 0) {
+		writeInts(output, triangles, count);
+		return;
+	}
+	indices = spSkeletonIndexPool_getIndices(attachment);
+	if (!indices) {
+		output->failed = 1;
+		return;
+	}
+	writeInt(output, count);
+	for (i = 0; i < count; ++i)
+		writeInt(output, indices[i]);
+}
+
+static void writeCurves (_spBakeOutput* output, const spCurveTimeline* timeline, int framesCount) {
+	if (framesCount > 1) writeBytes(output, timeline->curves, (framesCount - 1) * CURVE_SIZE * 4);
+}
+
+static void writeAttachment (_spBakeOutput* output, const spAttachment* attachment) {
+	writeString(output, attachment->name);
+	writeInt(output, attachment->type);
+	switch (attachment->type) {
+	case SP_ATTACHMENT_REGION: {
+		const spRegionAttachment* region = SUB_CAST(spRegionAttachment, attachment);
+		writeString(output, region->path);
+		writeFloat(output, region->x);
+		writeFloat(output, region->y);
+		writeFloat(output, region->scaleX);
+		writeFloat(output, region->scaleY);
+		writeFloat(output, region->rotation);
+		writeFloat(output, region->width);
+		writeFloat(output, region->height);
+		writeFloat(output, region->r);
+		writeFloat(output, region->g);
+		writeFloat(output, region->b);
+		writeFloat(output, region->a);
+		break;
+	}
+	case SP_ATTACHMENT_BOUNDING_BOX: {
+		const spBoundingBoxAttachment* box = SUB_CAST(spBoundingBoxAttachment, attachment);
+		writeFloats(output, box->vertices, box->verticesCount);
+		break;
+	}
+	case SP_ATTACHMENT_MESH: {
+		const spMeshAttachment* mesh = SUB_CAST(spMeshAttachment, attachment);
+		writeString(output, mesh->path);
+		writeFloats(output, mesh->vertices, mesh->verticesCount);
+		writeFloats(output, mesh->regionUVs, mesh->verticesCount);
+		writeTriangles(output, attachment, mesh->triangles, mesh->trianglesCount);
+		writeInts(output, mesh->edges, mesh->edgesCount);
+		writeInt(output, mesh->hullLength);
+		writeFloat(output, mesh->r);
+		writeFloat(output, mesh->g);
+		writeFloat(output, mesh->b);
+		writeFloat(output, mesh->a);
+		writeFloat(output, mesh->width);
+		writeFloat(output, mesh->height);
+		break;
+	}
+	case SP_ATTACHMENT_SKINNED_MESH: {
+		const spSkinnedMeshAttachment* mesh = SUB_CAST(spSkinnedMeshAttachment, attachment);
+		writeString(output, mesh->path);
+		writeInts(output, mesh->bones, mesh->bonesCount);
+		writeFloats(output, mesh->weights, mesh->weightsCount);
+		writeFloats(output, mesh->regionUVs, mesh->uvsCount);
+		writeTriangles(output, attachment, mesh->triangles, mesh->trianglesCount);
+		writeInts(output, mesh->edges, mesh->edgesCount);
+		writeInt(output, mesh->hullLength);
+		writeFloat(output, mesh->r);
+		writeFloat(output, mesh->g);
+		writeFloat(output, mesh->b);
+		writeFloat(output, mesh->a);
+		writeFloat(output, mesh->width);
+		writeFloat(output, mesh->height);
+		break;
+	}
+	}
+}
+
+static void writeSkin (_spBakeOutput* output, const spSkin* skin, const _spBakeSkin* entries) {
+	int i, ii;
+	writeString(output, skin->name);
+	writeInt(output, entries->slotStarts[entries->slotsCount]);
+	/* Newest entries come first, so each slot's entries are written oldest first to be added back in the same order. */
+	for (i = 0; i < entries->slotsCount; ++i) {
+		for (ii = entries->slotStarts[i + 1] - 1; ii >= entries->slotStarts[i]; --ii) {
+			writeInt(output, i);
+			writeString(output, entries->entries[ii].name);
+			writeAttachment(output, entries->entries[ii].attachment);
+		}
+	}
+}
+
+/* Writes the skin index and key of an FFD timeline's attachment: the newest name of its slot that finds it. */
+static void writeAttachmentKey (_spBakeOutput* output, const spSkeletonData* skeletonData, const spFFDTimeline* timeline) {
+	int i, ii, slotIndex = timeline->slotIndex;
+	if (slotIndex >= 0 && slotIndex < skeletonData->slotsCount) {
+		for (i = 0; i < skeletonData->skinsCount; ++i) {
+			const _spBakeSkin* entries = output->skins + i;
+			for (ii = entries->slotStarts[slotIndex]; ii < entries->slotStarts[slotIndex + 1]; ++ii) {
+				const _spBakeSkinEntry* entry = entries->entries + ii;
+				/* An older entry whose name a newer one replaced is not found by that name. */
+				if (entry->attachment != timeline->attachment
+						|| spSkin_getAttachment(skeletonData->skins[i], slotIndex, entry->name) != timeline->attachment) continue;
+				writeInt(output, i);
+				writeString(output, entry->name);
+				return;
+			}
+		}
+	}
+	/* Not in any skin. Reading fails on it, as reading the original skeleton would. */
+	writeInt(output, -1);
+	writeString(output, 0);
+}
+
+/* Whether the event's string is not its data's. Such strings are baked, the others are read as the data's. */
+static int hasOwnString (const spEvent* event) {
+	const char* defaultValue = event->data->stringValue;
+	if (event->stringValue == defaultValue) return 0;
+	return !event->stringValue || !defaultValue || strcmp(event->stringValue, defaultValue) != 0;
+}
+
+static void writeTimeline (_spBakeOutput* output, const spSkeletonData* skeletonData, const spTimeline* timeline) {
+	int i;
+	writeInt(output, timeline->type);
+	switch (timeline->type) {
+	case SP_TIMELINE_ROTATE:
+	case SP_TIMELINE_TRANSLATE:
+	case SP_TIMELINE_SCALE: {
+		const spBaseTimeline* base = SUB_CAST(spBaseTimeline, timeline);
+		int framesCount = base->framesCount / (timeline->type == SP_TIMELINE_ROTATE ? 2 : 3);
+		writeInt(output, framesCount);
+		writeInt(output, base->boneIndex);
+		writeBytes(output, base->frames, base->framesCount * 4);
+		writeCurves(output, SUPER(base), framesCount);
+		break;
+	}
+	case SP_TIMELINE_COLOR: {
+		const spColorTimeline* color = SUB_CAST(spColorTimeline, timeline);
+		writeInt(output, color->framesCount / 5);
+		writeInt(output, color->slotIndex);
+		writeBytes(output, color->frames, color->framesCount * 4);
+		writeCurves(output, SUPER(color), color->framesCount / 5);
+		break;
+	}
+	case SP_TIMELINE_ATTACHMENT: {
+		const spAttachmentTimeline* attachment = SUB_CAST(spAttachmentTimeline, timeline);
+		writeInt(output, attachment->framesCount);
+		writeInt(output, attachment->slotIndex);
+		writeBytes(output, attachment->frames, attachment->framesCount * 4);
+		for (i = 0; i < attachment->framesCount; ++i)
+			writeString(output, attachment->attachmentNames[i]);
+		break;
+	}
+	case SP_TIMELINE_EVENT: {
+		const spEventTimeline* event = SUB_CAST(spEventTimeline, timeline);
+		int stringsLength = 0;
+		for (i = 0; i < event->framesCount; ++i)
+			if (hasOwnString(event->events[i]) && event->events[i]->stringValue)
+				stringsLength += (int)strlen(event->events[i]->stringValue) + 1;
+		writeInt(output, event->framesCount);
+		writeInt(output, stringsLength);
+		writeBytes(output, event->frames, event->framesCount * 4);
+		for (i = 0; i < event->framesCount; ++i) {
+			const spEvent* frameEvent = event->events[i];
+			int ownString = hasOwnString(frameEvent);
+			writeInt(output, findPointer((void* const*)skeletonData->events, skeletonData->eventsCount, frameEvent->data));
+			writeInt(output, frameEvent->intValue);
+			writeFloat(output, frameEvent->floatValue);
+			writeInt(output, ownString);
+			if (ownString) writeString(output, frameEvent->stringValue);
+		}
+		break;
+	}
+	case SP_TIMELINE_DRAWORDER: {
+		/* Frames are the slot index and offset pairs of _spDrawOrderTimeline_createCompact. */
+		const spDrawOrderTimeline* drawOrder = SUB_CAST(spDrawOrderTimeline, timeline);
+		int* offsets = MALLOC(int, drawOrder->slotsCount * 2);
+		int pairsCount = 0;
+		for (i = 0; i < drawOrder->framesCount; ++i)
+			pairsCount += _spDrawOrderTimeline_getOffsets(drawOrder, i, offsets);
+		writeInt(output, drawOrder->framesCount);
+		writeInt(output, drawOrder->slotsCount);
+		writeInt(output, pairsCount);
+		writeBytes(output, drawOrder->frames, drawOrder->framesCount * 4);
+		for (i = 0; i < drawOrder->framesCount; ++i)
+			writeInts(output, offsets, _spDrawOrderTimeline_getOffsets(drawOrder, i, offsets) * 2);
+		FREE(offsets);
+		break;
+	}
+	case SP_TIMELINE_FFD: {
+		const spFFDTimeline* ffd = SUB_CAST(spFFDTimeline, timeline);
+		writeInt(output, ffd->framesCount);
+		writeInt(output, ffd->frameVerticesCount);
+		writeInt(output, ffd->slotIndex);
+		writeAttachmentKey(output, skeletonData, ffd);
+		writeBytes(output, ffd->frames, ffd->framesCount * 4);
+		writeCurves(output, SUPER(ffd), ffd->framesCount);
+		for (i = 0; i < ffd->framesCount; ++i)
+			writeFloats(output, ffd->frameVertices[i], ffd->frameVerticesCount);
+		break;
+	}
+	case SP_TIMELINE_IKCONSTRAINT: {
+		const spIkConstraintTimeline* ik = SUB_CAST(spIkConstraintTimeline, timeline);
+		writeInt(output, ik->framesCount / 3);
+		writeInt(output, ik->ikConstraintIndex);
+		writeBytes(output, ik->frames, ik->framesCount * 4);
+		writeCurves(output, SUPER(ik), ik->framesCount / 3);
+		break;
+	}
+	case SP_TIMELINE_FLIPX:
+	case SP_TIMELINE_FLIPY: {
+		const spFlipTimeline* flip = SUB_CAST(spFlipTimeline, timeline);
+		writeInt(output, flip->framesCount / 2);
+		writeInt(output, flip->boneIndex);
+		writeBytes(output, flip->frames, flip->framesCount * 4);
+		break;
+	}
+	}
+}
+
+unsigned char* spSkeletonBake_write (const spSkeletonData* skeletonData, int* length) {
+	_spBakeOutput output = {0, 0, 0, 0, 0};
+	int i, ii;
+	output.skins = CALLOC(_spBakeSkin, skeletonData->skinsCount);
+	for (i = 0; i < skeletonData->skinsCount; ++i)
+		groupSkin(output.skins + i, skeletonData->skins[i], skeletonData->slotsCount);
+
+	writeInt(&output, BAKE_MAGIC);
+	writeInt(&output, SP_SKELETON_BAKE_VERSION);
+	writeString(&output, skeletonData->hash);
+	writeString(&output, skeletonData->version);
+	writeFloat(&output, skeletonData->width);
+	writeFloat(&output, skeletonData->height);
+
+	writeInt(&output, skeletonData->bonesCount);
+	for (i = 0; i < skeletonData->bonesCount; ++i) {
+		const spBoneData* bone = skeletonData->bones[i];
+		writeString(&output, bone->name);
+		writeInt(&output, findPointer((void* const*)skeletonData->bones, i, bone->parent));
+		writeFloat(&output, bone->length);
+		writeFloat(&output, bone->x);
+		writeFloat(&output, bone->y);
+		writeFloat(&output, bone->rotation);
+		writeFloat(&output, bone->scaleX);
+		writeFloat(&output, bone->scaleY);
+		writeInt(&output, bone->flipX);
+		writeInt(&output, bone->flipY);
+		writeInt(&output, bone->inheritScale);
+		writeInt(&output, bone->inheritRotation);
+	}
+
+	writeInt(&output, skeletonData->ikConstraintsCount);
+	for (i = 0; i < skeletonData->ikConstraintsCount; ++i) {
+		const spIkConstraintData* ikConstraint = skeletonData->ikConstraints[i];
+		writeString(&output, ikConstraint->name);
+		writeInt(&output, ikConstraint->bonesCount);
+		for (ii = 0; ii < ikConstraint->bonesCount; ++ii)
+			writeInt(&output, findPointer((void* const*)skeletonData->bones, skeletonData->bonesCount, ikConstraint->bones[ii]));
+		writeInt(&output, findPointer((void* const*)skeletonData->bones, skeletonData->bonesCount, ikConstraint->target));
+		writeInt(&output, ikConstraint->bendDirection);
+		writeFloat(&output, ikConstraint->mix);
+	}
+
+	writeInt(&output, skeletonData->slotsCount);
+	for (i = 0; i < skeletonData->slotsCount; ++i) {
+		const spSlotData* slot = skeletonData->slots[i];
+		writeString(&output, slot->name);
+		writeInt(&output, findPointer((void* const*)skeletonData->bones, skeletonData->bonesCount, slot->boneData));
+		writeString(&output, slot->attachmentName);
+		writeFloat(&output, slot->r);
+		writeFloat(&output, slot->g);
+		writeFloat(&output, slot->b);
+		writeFloat(&output, slot->a);
+		writeInt(&output, slot->additiveBlending);
+	}
+
+	writeInt(&output, skeletonData->skinsCount);
+	writeInt(&output, findPointer((void* const*)skeletonData->skins, skeletonData->skinsCount, skeletonData->defaultSkin));
+	for (i = 0; i < skeletonData->skinsCount; ++i)
+		writeSkin(&output, skeletonData->skins[i], output.skins + i);
+
+	writeInt(&output, skeletonData->eventsCount);
+	for (i = 0; i < skeletonData->eventsCount; ++i) {
+		const spEventData* event = skeletonData->events[i];
+		writeString(&output, event->name);
+		writeInt(&output, event->intValue);
+		writeFloat(&output, event->floatValue);
+		writeString(&output, event->stringValue);
+	}
+
+	writeInt(&output, skeletonData->animationsCount);
+	for (i = 0; i < skeletonData->animationsCount; ++i) {
+		const spAnimation* animation = skeletonData->animations[i];
+		writeString(&output, animation->name);
+		writeFloat(&output, animation->duration);
+		writeInt(&output, animation->timelinesCount);
+		for (ii = 0; ii < animation->timelinesCount; ++ii)
+			writeTimeline(&output, skeletonData, animation->timelines[ii]);
+	}
+
+	for (i = 0; i < skeletonData->skinsCount; ++i) {
+		FREE(output.skins[i].entries);
+		FREE(output.skins[i].slotStarts);
+	}
+	FREE(output.skins);
+
+	if (output.failed) {
+		FREE(output.data);
+		*length = 0;
+		return 0;
+	}
+	*length = output.length;
+	return output.data;
+}
+
+/*====================  Reading  ====================*/
+
+typedef struct {
+	spSkeletonBinary* binary;
+	spSkeletonData* skeletonData;
+	const unsigned char* cursor;
+	const unsigned char* end;
+	int failed;
+} _spBakeInput;
+
+static void setError (_spBakeInput* input, const char* value1, const char* value2) {
+	char message[256];
+	int length;
+	spSkeletonBinary* binary = input->binary;
+	input->failed = 1;
+	if (binary->error) return; /* Keep the first error. */
+	strcpy(message, value1);
+	length = (int)strlen(value1);
+	if (value2) strncat(message + length, value2, 255 - length);
+	MALLOC_STR(binary->error, message);
+}
+
+/* Returns size bytes of the image, or 0 past its end. */
+static const void* readBytes (_spBakeInput* input, int size) {
+	const unsigned char* bytes = input->cursor;
+	if (input->failed) return 0;
+	if (size < 0 || size > input->end - input->cursor || getPadded(size) > input->end - input->cursor) {
+		setError(input, "Baked skeleton data corrupted.", 0);
+		return 0;
+	}
+	input->cursor += getPadded(size);
+	return bytes;
+}
+
+static int readInt (_spBakeInput* input) {
+	const int* value = (const int*)readBytes(input, 4);
+	return value ? *value : 0;
+}
+
+static float readFloat (_spBakeInput* input) {
+	const float* value = (const float*)readBytes(input, 4);
+	return value ? *value : 0;
+}
+
+/* Reads a count of items of itemSize bytes, failing if the image cannot hold them. */
+static int readCount (_spBakeInput* input, int itemSize) {
+	int count = readInt(input);
+	if (count < 0 || count > (input->end - input->cursor) / itemSize) {
+		setError(input, "Baked skeleton data corrupted.", 0);
+		return 0;
+	}
+	return count;
+}
+
+/* Reads an index into count items, -1 included if allowNone. */
+static int readIndex (_spBakeInput* input, int count, int /*bool*/ allowNone) {
+	int index = readInt(input);
+	if (index >= count || index < (allowNone ? -1 : 0)) {
+		setError(input, "Baked skeleton data corrupted.", 0);
+		return allowNone ? -1 : 0;
+	}
+	return index;
+}
+
+/* Returns the string in the image, or 0 for none. */
+static const char* readString (_spBakeInput* input) {
+	int length = readInt(input);
+	const char* value;
+	if (length == 0) return 0;
+	value = (const char*)readBytes(input, length);
+	if (!value) return 0;
+	if (value[length - 1] != 0) {
+		setError(input, "Baked skeleton data corrupted.", 0);
+		return 0;
+	}
+	return value;
+}
+
+static char* copyString (_spBakeInput* input) {
+	const char* value = readString(input);
+	char* copy = 0;
+	if (value) MALLOC_STR(copy, value);
+	return copy;
+}
+
+static void readInto (_spBakeInput* input, void* data, int size) {
+	const void* bytes = readBytes(input, size);
+	if (bytes && size > 0) memcpy(data, bytes, size);
+}
+
+/* Reads the count of an array of 4 byte items, -1 for none. */
+static int readArrayCount (_spBakeInput* input) {
+	int count = readInt(input);
+	if (count == -1) return -1;
+	if (count < 0 || count > (input->end - input->cursor) / 4) {
+		setError(input, "Baked skeleton data corrupted.", 0);
+		return -1;
+	}
+	return count;
+}
+
+static float* readFloats (_spBakeInput* input, int* count) {
+	float* values;
+	*count = readArrayCount(input);
+	if (*count < 0) {
+		*count = 0;
+		return 0;
+	}
+	values = MALLOC_ALIGNED(float, *count, SP_FLOAT_ALIGNMENT);
+	readInto(input, values, *count * 4);
+	return values;
+}
+
+static int* readInts (_spBakeInput* input, int* count) {
+	int* values;
+	*count = readArrayCount(input);
+	if (*count < 0) {
+		*count = 0;
+		return 0;
+	}
+	values = MALLOC(int, *count);
+	readInto(input, values, *count * 4);
+	return values;
+}
+
+static void readCurves (_spBakeInput* input, spCurveTimeline* timeline, int framesCount) {
+	if (framesCount > 1) readInto(input, timeline->curves, (framesCount - 1) * CURVE_SIZE * 4);
+}
+
+static spAttachment* readAttachment (_spBakeInput* input, spSkin* skin) {
+	spAttachmentLoader* loader = input->binary->attachmentLoader;
+	const char* name = readString(input);
+	spAttachmentType type = (spAttachmentType)readInt(input);
+	spAttachment* attachment;
+	char* path = 0;
+	if (!name) setError(input, "Baked skeleton data corrupted.", 0);
+	if (input->failed) return 0;
+
+	if (type != SP_ATTACHMENT_BOUNDING_BOX) {
+		path = copyString(input);
+		if (!path && name) MALLOC_STR(path, name);
+	}
+	attachment = spAttachmentLoader_newAttachment(loader, skin, type, name, path);
+	if (!attachment) {
+		FREE(path);
+		if (loader->error1)
+			setError(input, loader->error1, loader->error2);
+		else
+			setError(input, "Baked skeleton data corrupted.", 0);
+		return 0;
+	}
+
+	switch (type) {
+	case SP_ATTACHMENT_REGION: {
+		spRegionAttachment* region = SUB_CAST(spRegionAttachment, attachment);
+		region->path = path;
+		region->x = readFloat(input);
+		region->y = readFloat(input);
+		region->scaleX = readFloat(input);
+		region->scaleY = readFloat(input);
+		region->rotation = readFloat(input);
+		region->width = readFloat(input);
+		region->height = readFloat(input);
+		region->r = readFloat(input);
+		region->g = readFloat(input);
+		region->b = readFloat(input);
+		region->a = readFloat(input);
+		/* The offset depends on the atlas region, which may differ from the one the image was baked with. */
+		spRegionAttachment_updateOffset(region);
+		break;
+	}
+	case SP_ATTACHMENT_BOUNDING_BOX: {
+		spBoundingBoxAttachment* box = SUB_CAST(spBoundingBoxAttachment, attachment);
+		box->vertices = readFloats(input, &box->verticesCount);
+		break;
+	}
+	case SP_ATTACHMENT_MESH: {
+		spMeshAttachment* mesh = SUB_CAST(spMeshAttachment, attachment);
+		int uvsCount;
+		mesh->path = path;
+		mesh->vertices = readFloats(input, &mesh->verticesCount);
+		mesh->regionUVs = readFloats(input, &uvsCount);
+		mesh->triangles = readInts(input, &mesh->trianglesCount);
+		mesh->edges = readInts(input, &mesh->edgesCount);
+		mesh->hullLength = readInt(input);
+		mesh->r = readFloat(input);
+		mesh->g = readFloat(input);
+		mesh->b = readFloat(input);
+		mesh->a = readFloat(input);
+		mesh->width = readFloat(input);
+		mesh->height = readFloat(input);
+		if (uvsCount != mesh->verticesCount || uvsCount % 2 != 0) setError(input, "Baked skeleton data corrupted.", 0);
+		if (!input->failed) spMeshAttachment_updateUVs(mesh);
+		break;
+	}
+	case SP_ATTACHMENT_SKINNED_MESH: {
+		spSkinnedMeshAttachment* mesh = SUB_CAST(spSkinnedMeshAttachment, attachment);
+		mesh->path = path;
+		mesh->bones = readInts(input, &mesh->bonesCount);
+		mesh->weights = readFloats(input, &mesh->weightsCount);
+		mesh->regionUVs = readFloats(input, &mesh->uvsCount);
+		mesh->triangles = readInts(input, &mesh->trianglesCount);
+		mesh->edges = readInts(input, &mesh->edgesCount);
+		mesh->hullLength = readInt(input);
+		mesh->r = readFloat(input);
+		mesh->g = readFloat(input);
+		mesh->b = readFloat(input);
+		mesh->a = readFloat(input);
+		mesh->width = readFloat(input);
+		mesh->height = readFloat(input);
+		if (mesh->uvsCount % 2 != 0) setError(input, "Baked skeleton data corrupted.", 0);
+		if (!input->failed) spSkinnedMeshAttachment_updateUVs(mesh);
+		break;
+	}
+	}
+	return attachment;
+}
+
+static spSkin* readSkin (_spBakeInput* input) {
+	spSkeletonData* skeletonData = input->skeletonData;
+	const char* name = readString(input);
+	int i, entriesCount = readCount(input, 12);
+	spSkin* skin;
+	if (input->failed) return 0;
+
+	skin = spSkin_create(name ? name : "");
+	for (i = 0; i < entriesCount && !input->failed; ++i) {
+		int slotIndex = readIndex(input, skeletonData->slotsCount, 0);
+		const char* key = readString(input);
+		spAttachment* attachment = readAttachment(input, skin);
+		if (!attachment) break;
+		spSkin_addAttachment(skin, slotIndex, key ? key : attachment->name, attachment);
+	}
+	return skin;
+}
+
+/* Reads the keys count of a curve timeline, which has curves between at least one key. */
+static int readCurveKeysCount (_spBakeInput* input, int keySize) {
+	int keysCount = readCount(input, keySize);
+	if (keysCount < 1) setError(input, "Baked skeleton data corrupted.", 0);
+	return keysCount;
+}
+
+static spTimeline* readTimeline (_spBakeInput* input) {
+	spSkeletonData* skeletonData = input->skeletonData;
+	spTimelineType type = (spTimelineType)readInt(input);
+	int i, framesCount;
+	if (input->failed) return 0;
+
+	switch (type) {
+	case SP_TIMELINE_ROTATE:
+	case SP_TIMELINE_TRANSLATE:
+	case SP_TIMELINE_SCALE: {
+		spBaseTimeline* timeline;
+		framesCount = readCurveKeysCount(input, type == SP_TIMELINE_ROTATE ? 8 : 12);
+		if (input->failed) return 0;
+		timeline = type == SP_TIMELINE_ROTATE ? spRotateTimeline_create(framesCount)
+			: type == SP_TIMELINE_TRANSLATE ? spTranslateTimeline_create(framesCount) : spScaleTimeline_create(framesCount);
+		timeline->boneIndex = readIndex(input, skeletonData->bonesCount, 0);
+		readInto(input, timeline->frames, timeline->framesCount * 4);
+		readCurves(input, SUPER(timeline), framesCount);
+		return SUPER(SUPER(timeline));
+	}
+	case SP_TIMELINE_COLOR: {
+		spColorTimeline* timeline;
+		framesCount = readCurveKeysCount(input, 20);
+		if (input->failed) return 0;
+		timeline = spColorTimeline_create(framesCount);
+		timeline->slotIndex = readIndex(input, skeletonData->slotsCount, 0);
+		readInto(input, timeline->frames, timeline->framesCount * 4);
+		readCurves(input, SUPER(timeline), framesCount);
+		return SUPER(SUPER(timeline));
+	}
+	case SP_TIMELINE_ATTACHMENT: {
+		spAttachmentTimeline* timeline;
+		framesCount = readCount(input, 8);
+		if (input->failed) return 0;
+		timeline = _spAttachmentTimeline_createResolved(framesCount);
+		timeline->slotIndex = readIndex(input, skeletonData->slotsCount, 0);
+		readInto(input, timeline->frames, framesCount * 4);
+		for (i = 0; i < framesCount && !input->failed; ++i)
+			CONST_CAST(char*, timeline->attachmentNames[i]) = copyString(input);
+		if (!input->failed) _spAttachmentTimeline_resolve(timeline, skeletonData);
+		return SUPER(timeline);
+	}
+	case SP_TIMELINE_EVENT: {
+		spEventTimeline* timeline;
+		const float* frames;
+		int stringsLength;
+		framesCount = readCount(input, 20);
+		stringsLength = readCount(input, 1);
+		frames = (const float*)readBytes(input, framesCount * 4);
+		if (input->failed) return 0;
+		timeline = _spEventTimeline_createShared(framesCount, stringsLength);
+		for (i = 0; i < framesCount && !input->failed; ++i) {
+			int eventIndex = readIndex(input, skeletonData->eventsCount, 0);
+			int intValue = readInt(input);
+			float floatValue = readFloat(input);
+			const char* stringValue = 0;
+			int stringLength = -1;
+			if (readInt(input)) {
+				stringValue = readString(input);
+				stringLength = stringValue ? (int)strlen(stringValue) : 0;
+			}
+			if (input->failed) break;
+			if (!_spEventTimeline_setSharedFrame(timeline, i, frames[i], skeletonData->events[eventIndex], intValue, floatValue,
+					stringValue, stringLength))
+				setError(input, "Baked skeleton data corrupted.", 0);
+		}
+		return SUPER(timeline);
+	}
+	case SP_TIMELINE_DRAWORDER: {
+		spDrawOrderTimeline* timeline;
+		const float* frames;
+		int slotsCount, pairsCount;
+		framesCount = readCount(input, 8);
+		slotsCount = readInt(input);
+		if (slotsCount != skeletonData->slotsCount) setError(input, "Baked skeleton data corrupted.", 0);
+		pairsCount = readCount(input, 8);
+		frames = (const float*)readBytes(input, framesCount * 4);
+		if (input->failed) return 0;
+		timeline = _spDrawOrderTimeline_createCompact(framesCount, slotsCount, pairsCount);
+		for (i = 0; i < framesCount && !input->failed; ++i) {
+			int count = readArrayCount(input);
+			const int* offsets;
+			if (count % 2 != 0) setError(input, "Baked skeleton data corrupted.", 0);
+			offsets = (const int*)readBytes(input, count * 4);
+			if (offsets && !_spDrawOrderTimeline_setFrameOffsets(timeline, i, frames[i], offsets, count / 2))
+				setError(input, "Baked skeleton data corrupted.", 0);
+		}
+		return SUPER(timeline);
+	}
+	case SP_TIMELINE_FFD: {
+		spFFDTimeline* timeline;
+		spAttachment* attachment = 0;
+		int frameVerticesCount, slotIndex, skinIndex;
+		const char* key;
+		framesCount = readCurveKeysCount(input, 8);
+		frameVerticesCount = readCount(input, 1);
+		slotIndex = readIndex(input, skeletonData->slotsCount, 0);
+		skinIndex = readIndex(input, skeletonData->skinsCount, 1);
+		key = readString(input);
+		if (input->failed) return 0;
+		if (skinIndex >= 0 && key) attachment = spSkin_getAttachment(skeletonData->skins[skinIndex], slotIndex, key);
+		if (!attachment) {
+			setError(input, "Attachment not found: ", key);
+			return 0;
+		}
+		timeline = spFFDTimeline_create(framesCount, frameVerticesCount);
+		timeline->slotIndex = slotIndex;
+		timeline->attachment = attachment;
+		readInto(input, timeline->frames, framesCount * 4);
+		readCurves(input, SUPER(timeline), framesCount);
+		for (i = 0; i < framesCount && !input->failed; ++i) {
+			int count;
+			CONST_CAST(float*, timeline->frameVertices[i]) = readFloats(input, &count);
+			if (timeline->frameVertices[i] && count != frameVerticesCount) setError(input, "Baked skeleton data corrupted.", 0);
+		}
+		return SUPER(SUPER(timeline));
+	}
+	case SP_TIMELINE_IKCONSTRAINT: {
+		spIkConstraintTimeline* timeline;
+		framesCount = readCurveKeysCount(input, 12);
+		if (input->failed) return 0;
+		timeline = spIkConstraintTimeline_create(framesCount);
+		timeline->ikConstraintIndex = readIndex(input, skeletonData->ikConstraintsCount, 1);
+		readInto(input, timeline->frames, timeline->framesCount * 4);
+		readCurves(input, SUPER(timeline), framesCount);
+		return SUPER(SUPER(timeline));
+	}
+	case SP_TIMELINE_FLIPX:
+	case SP_TIMELINE_FLIPY: {
+		spFlipTimeline* timeline;
+		framesCount = readCount(input, 8);
+		if (input->failed) return 0;
+		timeline = spFlipTimeline_create(framesCount, type == SP_TIMELINE_FLIPX);
+		timeline->boneIndex = readIndex(input, skeletonData->bonesCount, 0);
+		readInto(input, timeline->frames, timeline->framesCount * 4);
+		return SUPER(timeline);
+	}
+	}
+	setError(input, "Baked skeleton data corrupted.", 0);
+	return 0;
+}
+
+static spAnimation* readAnimation (_spBakeInput* input) {
+	const char* name = readString(input);
+	float duration = readFloat(input);
+	int timelinesCount = readCount(input, 8);
+	spAnimation* animation;
+	if (input->failed) return 0;
+
+	animation = spAnimation_create(name ? name : "", timelinesCount);
+	animation->duration = duration;
+	/* Counts the timelines read so far, so a partly read animation is disposed safely. */
+	animation->timelinesCount = 0;
+	while (animation->timelinesCount < timelinesCount) {
+		spTimeline* timeline = readTimeline(input);
+		if (timeline) animation->timelines[animation->timelinesCount++] = timeline;
+		if (input->failed) break;
+	}
+	return animation;
+}
+
+static spBoneData* readBone (_spBakeInput* input) {
+	int index = readIndex(input, input->skeletonData->bonesCount, 0);
+	return input->failed ? 0 : input->skeletonData->bones[index];
+}
+
+/* Reads the items of skeletonData, counting each as it is added so a failed read leaves it safe to dispose. */
+static void readItems (_spBakeInput* input) {
+	spSkeletonData* skeletonData = input->skeletonData;
+	int i, ii, count, defaultSkin;
+
+	count = readCount(input, 48);
+	skeletonData->bones = MALLOC(spBoneData*, count);
+	for (i = 0; i < count && !input->failed; ++i) {
+		const char* name = readString(input);
+		int parentIndex = readIndex(input, i, 1);
+		spBoneData* bone;
+		if (input->failed) return;
+		bone = spBoneData_create(name ? name : "", parentIndex < 0 ? 0 : skeletonData->bones[parentIndex]);
+		bone->length = readFloat(input);
+		bone->x = readFloat(input);
+		bone->y = readFloat(input);
+		bone->rotation = readFloat(input);
+		bone->scaleX = readFloat(input);
+		bone->scaleY = readFloat(input);
+		bone->flipX = readInt(input);
+		bone->flipY = readInt(input);
+		bone->inheritScale = readInt(input);
+		bone->inheritRotation = readInt(input);
+		skeletonData->bones[skeletonData->bonesCount++] = bone;
+	}
+
+	count = readCount(input, 20);
+	skeletonData->ikConstraints = MALLOC(spIkConstraintData*, count);
+	for (i = 0; i < count && !input->failed; ++i) {
+		const char* name = readString(input);
+		int bonesCount = readCount(input, 4);
+		spIkConstraintData* ikConstraint;
+		if (input->failed) return;
+		ikConstraint = spIkConstraintData_create(name ? name : "");
+		skeletonData->ikConstraints[skeletonData->ikConstraintsCount++] = ikConstraint;
+		ikConstraint->bones = MALLOC(spBoneData*, bonesCount);
+		ikConstraint->bonesCount = bonesCount;
+		for (ii = 0; ii < bonesCount; ++ii)
+			ikConstraint->bones[ii] = readBone(input);
+		ikConstraint->target = readBone(input);
+		ikConstraint->bendDirection = readInt(input);
+		ikConstraint->mix = readFloat(input);
+	}
+
+	count = readCount(input, 32);
+	skeletonData->slots = MALLOC(spSlotData*, count);
+	for (i = 0; i < count && !input->failed; ++i) {
+		const char* name = readString(input);
+		int boneIndex = readIndex(input, skeletonData->bonesCount, 0);
+		spSlotData* slot;
+		if (input->failed) return;
+		slot = spSlotData_create(name ? name : "", skeletonData->bones[boneIndex]);
+		skeletonData->slots[skeletonData->slotsCount++] = slot;
+		slot->attachmentName = copyString(input);
+		slot->r = readFloat(input);
+		slot->g = readFloat(input);
+		slot->b = readFloat(input);
+		slot->a = readFloat(input);
+		slot->additiveBlending = readInt(input);
+	}
+
+	count = readCount(input, 8);
+	defaultSkin = readIndex(input, count, 1);
+	skeletonData->skins = MALLOC(spSkin*, count);
+	for (i = 0; i < count && !input->failed; ++i) {
+		spSkin* skin = readSkin(input);
+		if (skin) skeletonData->skins[skeletonData->skinsCount++] = skin;
+	}
+	if (input->failed) return;
+	if (defaultSkin >= 0) skeletonData->defaultSkin = skeletonData->skins[defaultSkin];
+
+	count = readCount(input, 16);
+	skeletonData->events = MALLOC(spEventData*, count);
+	for (i = 0; i < count && !input->failed; ++i) {
+		const char* name = readString(input);
+		spEventData* event;
+		if (input->failed) return;
+		event = spEventData_create(name ? name : "");
+		skeletonData->events[skeletonData->eventsCount++] = event;
+		event->intValue = readInt(input);
+		event->floatValue = readFloat(input);
+		event->stringValue = copyString(input);
+	}
+
+	count = readCount(input, 12);
+	skeletonData->animations = MALLOC(spAnimation*, count);
+	for (i = 0; i < count && !input->failed; ++i) {
+		spAnimation* animation = readAnimation(input);
+		if (animation) skeletonData->animations[skeletonData->animationsCount++] = animation;
+	}
+}
+
+spSkeletonData* spSkeletonBake_read (spSkeletonBinary* binary, const unsigned char* image, int length) {
+	const spAllocator* previous = spAllocator_setCurrent(binary->allocator);
+	_spBakeInput input;
+	spSkeletonData* skeletonData;
+
+	FREE(binary->error);
+	CONST_CAST(char*, binary->error) = 0;
+
+	input.binary = binary;
+	input.skeletonData = 0;
+	input.cursor = image;
+	input.end = image + length;
+	input.failed = 0;
+
+	if (((uintptr_t)image & 3) != 0) {
+		setError(&input, "Baked skeleton data is not 4 byte aligned.", 0);
+		spAllocator_setCurrent(previous);
+		return 0;
+	}
+	if (readInt(&input) != BAKE_MAGIC || readInt(&input) != SP_SKELETON_BAKE_VERSION) {
+		/* Keeps the error of a truncated header. */
+		setError(&input, "Not a baked skeleton of this version and byte order.", 0);
+		spAllocator_setCurrent(previous);
+		return 0;
+	}
+
+	skeletonData = spSkeletonData_create();
+	input.skeletonData = skeletonData;
+	skeletonData->hash = copyString(&input);
+	skeletonData->version = copyString(&input);
+	skeletonData->width = readFloat(&input);
+	skeletonData->height = readFloat(&input);
+	readItems(&input);
+	if (input.cursor != input.end) setError(&input, "Baked skeleton data corrupted.", 0);
+
+	if (input.failed) {
+		spSkeletonData_dispose(skeletonData);
+		skeletonData = 0;
+	}
+	spAllocator_setCurrent(previous);
+	return skeletonData;
+}
@@ -1,4 +1,7 @@
 ﻿
+#if defined(SPINE_BINARY_PROFILE) && !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L /* clock_gettime */
+#endif
 
 #include <spine/Animation.h>
 #include <spine/Array.h>
@@ -7,20 +10,248 @@
 #include <spine/extension.h>
 
 #include <stdint.h>
-
-_SP_ARRAY_DECLARE_TYPE(spTimelineArray, spTimeline*)
-_SP_ARRAY_IMPLEMENT_TYPE(spTimelineArray, spTimeline*)
+#ifdef SPINE_BINARY_PROFILE
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#endif
+
+/* Scratch buffers for decoding timelines, on the stack unless an animation has many timelines, a skeleton has many slots or
+ * a mesh has many vertices. */
+_SP_ARRAY_DEFINE_TYPE_INLINE_STATIC(_spTimelineInlineArray, spTimeline*, 32)
+_SP_ARRAY_DEFINE_TYPE_INLINE_STATIC(_spIntInlineArray, int, 64)
+_SP_ARRAY_DEFINE_TYPE_INLINE_STATIC(_spFloatInlineArray, float, 256)
 
 typedef struct {
 	const unsigned char* cursor;
 	const unsigned char* end;
+	int overflow; /* Set by scanning when the data ends before the step does. */
 } _dataInput;
 
+/* A load advances in steps, each reading the item count of a section or one of its items, so a stream can read each step
+ * as soon as its bytes have arrived. */
+typedef enum {
+	SP_LOAD_HEADER,
+	SP_LOAD_BONES_COUNT,
+	SP_LOAD_BONE,
+	SP_LOAD_IK_CONSTRAINTS_COUNT,
+	SP_LOAD_IK_CONSTRAINT,
+	SP_LOAD_SLOTS_COUNT,
+	SP_LOAD_SLOT,
+	SP_LOAD_DEFAULT_SKIN,
+	SP_LOAD_SKINS_COUNT,
+	SP_LOAD_SKIN,
+	SP_LOAD_EVENTS_COUNT,
+	SP_LOAD_EVENT,
+	SP_LOAD_ANIMATIONS_COUNT,
+	SP_LOAD_ANIMATION,
+	SP_LOAD_DONE
+} _spLoadStep;
+
+typedef struct {
+	spSkeletonData* skeletonData;
+	_spLoadStep step;
+	int count; /* Items of the current section. The skeleton data's own count is the number read so far. */
+	int index; /* Skins or animations read or skipped so far, when the filter can skip them. */
+	int nonessential;
+	int* skinIndices; /* Index in the skeleton data of each skin in the file, -1 if skipped. 0 unless skins are filtered. */
+	spUnsignedShortArray* indices; /* Of the index pool, 0 unless the binary pools indices. */
+	struct _spIndexPoolEntry* indexEntries; /* Meshes whose triangles are in indices. */
+	int indexEntriesCount, indexEntriesCapacity;
+	struct _spMeshArrayEntry* meshArrays; /* Hash table of the geometry arrays read so far, 0 unless the binary shares meshes. */
+	int meshArraysCount, meshArraysCapacity;
+} _spLoad;
+
 typedef struct {
 	spSkeletonBinary super;
 	int ownsLoader;
+#ifdef SPINE_BINARY_PROFILE
+	spSkeletonBinarySkinProfile* currentSkin; /* Receives the attachment loader's share of the skin being read. */
+	spSkeletonBinaryAnimationProfile* currentAnimation;
+#endif
 } _spSkeletonBinary;
 
+typedef struct {
+	spSkeletonBinaryStream super;
+	_spLoad load;
+	unsigned char* buffer;
+	int bufferCapacity;
+	int scanLength; /* Buffered bytes needed before the incomplete step is scanned again. */
+	int failed;
+} _spSkeletonBinaryStream;
+
+/*====================  Load profile  ====================*/
+
+#ifdef SPINE_BINARY_PROFILE
+
+static const spSkeletonBinarySection stepSections[SP_LOAD_DONE + 1] = {
+	SP_BINARY_SECTION_HEADER,
+	SP_BINARY_SECTION_BONES, SP_BINARY_SECTION_BONES,
+	SP_BINARY_SECTION_IK_CONSTRAINTS, SP_BINARY_SECTION_IK_CONSTRAINTS,
+	SP_BINARY_SECTION_SLOTS, SP_BINARY_SECTION_SLOTS,
+	SP_BINARY_SECTION_SKINS, SP_BINARY_SECTION_SKINS, SP_BINARY_SECTION_SKINS,
+	SP_BINARY_SECTION_EVENTS, SP_BINARY_SECTION_EVENTS,
+	SP_BINARY_SECTION_ANIMATIONS, SP_BINARY_SECTION_ANIMATIONS,
+	SP_BINARY_SECTION_ANIMATIONS
+};
+
+/* Start of a profiled span. */
+typedef struct {
+	double time;
+	const unsigned char* cursor;
+	size_t allocations, allocatedBytes;
+} _spProfileMark;
+
+static double getSeconds() {
+#if defined(_WIN32)
+	LARGE_INTEGER frequency, counter;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&counter);
+	return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+#endif
+}
+
+static void markProfile(_spProfileMark* mark, const unsigned char* cursor) {
+	_spAllocationCounts_get(&mark->allocations, &mark->allocatedBytes);
+	mark->cursor = cursor;
+	mark->time = getSeconds();
+}
+
+/* Adds the span from mark to now to entry. */
+static void addProfile(spSkeletonBinaryProfileEntry* entry, const _spProfileMark* mark, const unsigned char* cursor) {
+	size_t allocations, allocatedBytes;
+	entry->seconds += getSeconds() - mark->time;
+	entry->bytes += (int)(cursor - mark->cursor);
+	_spAllocationCounts_get(&allocations, &allocatedBytes);
+	entry->allocations += (int)(allocations - mark->allocations);
+	entry->allocatedBytes += allocatedBytes - mark->allocatedBytes;
+}
+
+/* The profile is allocated with the system allocator so it neither counts as an allocation of the read nor depends on the
+ * binary's allocator context. */
+static char* copyProfileName(const char* name) {
+	char* copy = (char*)malloc(strlen(name) + 1);
+	if (copy) strcpy(copy, name);
+	return copy;
+}
+
+static void disposeProfile(spSkeletonBinaryProfile* profile) {
+	int i;
+	if (!profile) return;
+	for (i = 0; i < profile->skinsCount; ++i)
+		free((char*)profile->skins[i].super.name);
+	for (i = 0; i < profile->animationsCount; ++i)
+		free((char*)profile->animations[i].super.name);
+	free(profile->skins);
+	free(profile->animations);
+	free(profile);
+}
+
+static void resetProfile(spSkeletonBinary* self) {
+	static const char* sectionNames[SP_BINARY_SECTIONS_COUNT] = {
+		"header", "bones", "ik_constraints", "slots", "skins", "events", "animations"
+	};
+	spSkeletonBinaryProfile* profile = (spSkeletonBinaryProfile*)calloc(1, sizeof(spSkeletonBinaryProfile));
+	int i;
+	disposeProfile((spSkeletonBinaryProfile*)self->profile);
+	CONST_CAST(const spSkeletonBinaryProfile*, self->profile) = profile;
+	if (!profile) return;
+	profile->total.name = "total";
+	for (i = 0; i < SP_BINARY_SECTIONS_COUNT; ++i)
+		profile->sections[i].name = sectionNames[i];
+}
+
+static spSkeletonBinarySkinProfile* addSkinProfile(spSkeletonBinary* self, const char* name) {
+	spSkeletonBinaryProfile* profile = (spSkeletonBinaryProfile*)self->profile;
+	spSkeletonBinarySkinProfile* skins;
+	if (!profile) return NULL;
+	skins = (spSkeletonBinarySkinProfile*)realloc(profile->skins, sizeof(spSkeletonBinarySkinProfile) * (profile->skinsCount + 1));
+	if (!skins) return NULL;
+	profile->skins = skins;
+	memset(skins + profile->skinsCount, 0, sizeof(spSkeletonBinarySkinProfile));
+	skins[profile->skinsCount].super.name = copyProfileName(name);
+	skins[profile->skinsCount].attachmentLoader.name = "attachment_loader";
+	return skins + profile->skinsCount++;
+}
+
+static void reserveAnimationProfiles(spSkeletonBinary* self, int count) {
+	static const char* groupNames[SP_BINARY_GROUPS_COUNT] = {
+		"slot_timelines", "bone_timelines", "ik_timelines", "ffd_timelines", "draw_order", "events"
+	};
+	spSkeletonBinaryProfile* profile = (spSkeletonBinaryProfile*)self->profile;
+	int i, ii;
+	if (!profile || count <= 0) return;
+	profile->animations = (spSkeletonBinaryAnimationProfile*)calloc(count, sizeof(spSkeletonBinaryAnimationProfile));
+	if (!profile->animations) return;
+	for (i = 0; i < count; ++i)
+		for (ii = 0; ii < SP_BINARY_GROUPS_COUNT; ++ii)
+			profile->animations[i].groups[ii].name = groupNames[ii];
+}
+
+static spSkeletonBinaryAnimationProfile* getAnimationProfile(spSkeletonBinary* self, int index, const char* name) {
+	spSkeletonBinaryProfile* profile = (spSkeletonBinaryProfile*)self->profile;
+	if (!profile || !profile->animations) return NULL;
+	profile->animations[index].super.name = copyProfileName(name);
+	profile->animationsCount = index + 1;
+	return profile->animations + index;
+}
+
+#define PROFILE_RESET(SELF) resetProfile(SELF)
+#define PROFILE_RESERVE_ANIMATIONS(SELF, COUNT) reserveAnimationProfiles(SELF, COUNT)
+#define PROFILE_MARK(MARK) _spProfileMark MARK
+#define PROFILE_BEGIN(MARK, INPUT) markProfile(&(MARK), (INPUT)->cursor)
+/* Adds the span since MARK to the section STEP belongs to and to the total. */
+#define PROFILE_STEP(SELF, STEP, MARK, INPUT) do { \
+	if ((SELF)->profile) { \
+		addProfile((spSkeletonBinaryProfileEntry*)&(SELF)->profile->sections[stepSections[STEP]], &(MARK), (INPUT)->cursor); \
+		addProfile((spSkeletonBinaryProfileEntry*)&(SELF)->profile->total, &(MARK), (INPUT)->cursor); \
+	} \
+} while (0)
+#define PROFILE_BEGIN_SKIN(SELF, NAME, MARK, INPUT) do { \
+	SUB_CAST(_spSkeletonBinary, SELF)->currentSkin = addSkinProfile(SELF, NAME); \
+	markProfile(&(MARK), (INPUT)->cursor); \
+} while (0)
+#define PROFILE_END_SKIN(SELF, MARK, INPUT) do { \
+	_spSkeletonBinary* internal_ = SUB_CAST(_spSkeletonBinary, SELF); \
+	if (internal_->currentSkin) addProfile(&internal_->currentSkin->super, &(MARK), (INPUT)->cursor); \
+	internal_->currentSkin = NULL; \
+} while (0)
+#define PROFILE_BEGIN_ANIMATION(SELF, INDEX, NAME, MARK, INPUT) do { \
+	SUB_CAST(_spSkeletonBinary, SELF)->currentAnimation = getAnimationProfile(SELF, INDEX, NAME); \
+	markProfile(&(MARK), (INPUT)->cursor); \
+} while (0)
+#define PROFILE_END_ANIMATION(SELF, MARK, INPUT) do { \
+	_spSkeletonBinary* internal_ = SUB_CAST(_spSkeletonBinary, SELF); \
+	if (internal_->currentAnimation) addProfile(&internal_->currentAnimation->super, &(MARK), (INPUT)->cursor); \
+	internal_->currentAnimation = NULL; \
+} while (0)
+#define PROFILE_GROUP(SELF, GROUP, MARK, INPUT) do { \
+	_spSkeletonBinary* internal_ = SUB_CAST(_spSkeletonBinary, SELF); \
+	if (internal_->currentAnimation) addProfile(&internal_->currentAnimation->groups[GROUP], &(MARK), (INPUT)->cursor); \
+	markProfile(&(MARK), (INPUT)->cursor); \
+} while (0)
+
+#else
+
+#define PROFILE_RESET(SELF)
+#define PROFILE_RESERVE_ANIMATIONS(SELF, COUNT)
+#define PROFILE_MARK(MARK)
+#define PROFILE_BEGIN(MARK, INPUT)
+#define PROFILE_STEP(SELF, STEP, MARK, INPUT)
+#define PROFILE_BEGIN_SKIN(SELF, NAME, MARK, INPUT)
+#define PROFILE_END_SKIN(SELF, MARK, INPUT)
+#define PROFILE_BEGIN_ANIMATION(SELF, INDEX, NAME, MARK, INPUT)
+#define PROFILE_END_ANIMATION(SELF, MARK, INPUT)
+#define PROFILE_GROUP(SELF, GROUP, MARK, INPUT)
+
+#endif /* SPINE_BINARY_PROFILE */
+
 /*====================  Internal free functions ====================*/
 
 static unsigned char readByte(_dataInput* input) {
@@ -96,7 +327,7 @@ static void readColor(_dataInput* input, float* r, float* g, float* b, float* a)
 static void readFloatArray(_dataInput* input, float scale, float** data, int *size)
 {
 	*size = readVarint(input, 1);
-	*data = MALLOC(float, *size);
+	*data = MALLOC_ALIGNED(float, *size, SP_FLOAT_ALIGNMENT);
 	for (int i = 0; i < *size; ++i)
 	{
 		*(*data + i) = readFloat(input) * scale;
@@ -124,6 +355,178 @@ static void readIntArray(_dataInput* input, int** data, int* size)
 	}
 }
 
+typedef struct _spIndexPoolEntry {
+	spAttachment* attachment;
+	int offset; /* Of the attachment's first index in the load's indices. */
+} _spIndexPoolEntry;
+
+/* Reads a mesh's triangles into the load's index pool, if it has one, leaving the attachment's int triangles 0. The mesh is
+ * pointed at them once the pool is created. */
+static void readTriangles(_dataInput* input, _spLoad* load, spAttachment* attachment, int** triangles, int* trianglesCount)
+{
+	if (!load->indices) {
+		readShortArray(input, triangles, trianglesCount);
+		return;
+	}
+	spUnsignedShortArray* indices = load->indices;
+	int count = readVarint(input, 1);
+	if (indices->size + count > indices->capacity)
+		spUnsignedShortArray_ensureCapacity(indices, MAX(indices->size + count, indices->capacity * 2));
+	if (load->indexEntriesCount == load->indexEntriesCapacity) {
+		load->indexEntriesCapacity = MAX(load->indexEntriesCapacity * 2, 16);
+		load->indexEntries = REALLOC(load->indexEntries, _spIndexPoolEntry, load->indexEntriesCapacity);
+	}
+	load->indexEntries[load->indexEntriesCount].attachment = attachment;
+	load->indexEntries[load->indexEntriesCount++].offset = indices->size;
+	for (int i = 0; i < count; ++i) {
+		unsigned short index = (unsigned short)(readByte(input) << 8);
+		indices->items[indices->size++] = index | readByte(input);
+	}
+	*triangles = NULL;
+	*trianglesCount = count;
+}
+
+typedef struct _spMeshArrayEntry {
+	void* data; /* 0 for an empty slot. */
+	int size; /* In bytes. */
+	_spMeshArray kind;
+	unsigned int hash;
+	spAttachment* owner; /* The attachment which read the array. */
+	int* refs; /* Attachments using the array, 0 until it is shared. */
+} _spMeshArrayEntry;
+
+/* Points arrays at the attachment's geometry arrays, 0 for those it has not, and sizes at their sizes in bytes. */
+static void getMeshArrays(spAttachment* attachment, void** arrays[], int sizes[])
+{
+	for (int i = 0; i < SP_MESH_ARRAYS_COUNT; ++i) {
+		arrays[i] = NULL;
+		sizes[i] = 0;
+	}
+	if (attachment->type == SP_ATTACHMENT_MESH) {
+		spMeshAttachment* mesh = SUB_CAST(spMeshAttachment, attachment);
+		arrays[SP_MESH_ARRAY_UVS] = (void**)&mesh->regionUVs;
+		sizes[SP_MESH_ARRAY_UVS] = (int)sizeof(float) * mesh->verticesCount;
+		arrays[SP_MESH_ARRAY_TRIANGLES] = (void**)&mesh->triangles;
+		sizes[SP_MESH_ARRAY_TRIANGLES] = (int)sizeof(int) * mesh->trianglesCount;
+		arrays[SP_MESH_ARRAY_VERTICES] = (void**)&mesh->vertices;
+		sizes[SP_MESH_ARRAY_VERTICES] = (int)sizeof(float) * mesh->verticesCount;
+		arrays[SP_MESH_ARRAY_EDGES] = (void**)&mesh->edges;
+		sizes[SP_MESH_ARRAY_EDGES] = (int)sizeof(int) * mesh->edgesCount;
+	} else if (attachment->type == SP_ATTACHMENT_SKINNED_MESH) {
+		spSkinnedMeshAttachment* mesh = SUB_CAST(spSkinnedMeshAttachment, attachment);
+		arrays[SP_MESH_ARRAY_UVS] = (void**)&mesh->regionUVs;
+		sizes[SP_MESH_ARRAY_UVS] = (int)sizeof(float) * mesh->uvsCount;
+		arrays[SP_MESH_ARRAY_TRIANGLES] = (void**)&mesh->triangles;
+		sizes[SP_MESH_ARRAY_TRIANGLES] = (int)sizeof(int) * mesh->trianglesCount;
+		arrays[SP_MESH_ARRAY_VERTICES] = (void**)&mesh->weights;
+		sizes[SP_MESH_ARRAY_VERTICES] = (int)sizeof(float) * mesh->weightsCount;
+		arrays[SP_MESH_ARRAY_BONES] = (void**)&mesh->bones;
+		sizes[SP_MESH_ARRAY_BONES] = (int)sizeof(int) * mesh->bonesCount;
+		arrays[SP_MESH_ARRAY_EDGES] = (void**)&mesh->edges;
+		sizes[SP_MESH_ARRAY_EDGES] = (int)sizeof(int) * mesh->edgesCount;
+	}
+}
+
+static void shareMeshArray(spAttachment* attachment, _spMeshArray array, int* refs)
+{
+	if (attachment->type == SP_ATTACHMENT_MESH)
+		_spMeshAttachment_shareArray(SUB_CAST(spMeshAttachment, attachment), array, refs);
+	else
+		_spSkinnedMeshAttachment_shareArray(SUB_CAST(spSkinnedMeshAttachment, attachment), array, refs);
+}
+
+static unsigned int hashMeshArray(const void* data, int size)
+{
+	/* FNV-1a over the 4 byte elements. */
+	const uint32_t* words = (const uint32_t*)data;
+	unsigned int hash = 2166136261u;
+	for (int i = 0, n = size / 4; i < n; ++i)
+		hash = (hash ^ words[i]) * 16777619u;
+	return hash;
+}
+
+static void addMeshArrayEntry(_spLoad* load, const _spMeshArrayEntry* entry)
+{
+	if ((load->meshArraysCount + 1) * 2 > load->meshArraysCapacity) {
+		_spMeshArrayEntry* entries = load->meshArrays;
+		int capacity = load->meshArraysCapacity;
+		load->meshArraysCapacity = MAX(capacity * 2, 64);
+		load->meshArrays = CALLOC(_spMeshArrayEntry, load->meshArraysCapacity);
+		load->meshArraysCount = 0;
+		for (int i = 0; i < capacity; ++i)
+			if (entries[i].data) addMeshArrayEntry(load, entries + i);
+		FREE(entries);
+	}
+	int mask = load->meshArraysCapacity - 1;
+	int i = (int)(entry->hash & (unsigned int)mask);
+	while (load->meshArrays[i].data)
+		i = (i + 1) & mask;
+	load->meshArrays[i] = *entry;
+	++load->meshArraysCount;
+}
+
+static _spMeshArrayEntry* findMeshArrayEntry(_spLoad* load, const void* data, int size, _spMeshArray kind, unsigned int hash)
+{
+	if (!load->meshArrays) return NULL;
+	int mask = load->meshArraysCapacity - 1;
+	for (int i = (int)(hash & (unsigned int)mask); load->meshArrays[i].data; i = (i + 1) & mask) {
+		_spMeshArrayEntry* entry = load->meshArrays + i;
+		if (entry->hash == hash && entry->kind == kind && entry->size == size && memcmp(entry->data, data, size) == 0)
+			return entry;
+	}
+	return NULL;
+}
+
+/* Counts the geometry arrays of a mesh just read and, when the binary shares meshes, replaces those identical to an array
+ * read before by that array. */
+static void shareMeshArrays(spSkeletonBinary* self, _spLoad* load, spAttachment* attachment)
+{
+	spSkeletonBinaryMeshStats* stats = (spSkeletonBinaryMeshStats*)&self->meshStats;
+	void** arrays[SP_MESH_ARRAYS_COUNT];
+	int sizes[SP_MESH_ARRAYS_COUNT];
+	getMeshArrays(attachment, arrays, sizes);
+	for (int i = 0; i < SP_MESH_ARRAYS_COUNT; ++i) {
+		/* Pooled triangles are left 0. */
+		if (!arrays[i] || !*arrays[i] || sizes[i] == 0) continue;
+		++stats->arraysCount;
+		stats->bytes += sizes[i];
+		if (!self->shareMeshes) {
+			stats->sharedBytes += sizes[i];
+			continue;
+		}
+
+		unsigned int hash = hashMeshArray(*arrays[i], sizes[i]);
+		_spMeshArrayEntry* entry = findMeshArrayEntry(load, *arrays[i], sizes[i], (_spMeshArray)i, hash);
+		if (!entry) {
+			_spMeshArrayEntry added = {*arrays[i], sizes[i], (_spMeshArray)i, hash, attachment, NULL};
+			addMeshArrayEntry(load, &added);
+			stats->sharedBytes += sizes[i];
+			continue;
+		}
+		if (!entry->refs) {
+			entry->refs = NEW(int);
+			*entry->refs = 1;
+			shareMeshArray(entry->owner, (_spMeshArray)i, entry->refs);
+		}
+		++*entry->refs;
+		shareMeshArray(attachment, (_spMeshArray)i, entry->refs);
+		FREE(*arrays[i]);
+		*arrays[i] = entry->data;
+		++stats->sharedArraysCount;
+	}
+}
+
+static void disposeLoadMeshArrays(_spLoad* load) {
+	FREE(load->meshArrays);
+	load->meshArrays = NULL;
+	load->meshArraysCount = 0;
+	load->meshArraysCapacity = 0;
+}
+
+static void resetMeshStats(spSkeletonBinary* self) {
+	memset((spSkeletonBinaryMeshStats*)&self->meshStats, 0, sizeof(spSkeletonBinaryMeshStats));
+}
+
 /* Should not use spTimelineType enumeration when reading timelines. */
 typedef enum {
 	SP_BINARY_TIMELINE_SCALE,
@@ -158,6 +561,323 @@ static void readCurve(_dataInput* input, spCurveTimeline* timeline, int frameInd
 	}
 }
 
+int _spSkeletonBinary_readVarints(const unsigned char* data, int count, int /*bool*/ optimizePositive, int* values) {
+	_dataInput input = {data, 0, 0};
+	int i;
+	for (i = 0; i < count; ++i)
+		values[i] = readVarint(&input, optimizePositive);
+	return (int)(input.cursor - data);
+}
+
+int _spSkeletonBinary_readFloatArray(const unsigned char* data, float scale, float** values, int* size) {
+	_dataInput input = {data, 0, 0};
+	readFloatArray(&input, scale, values, size);
+	return (int)(input.cursor - data);
+}
+
+/*====================  Step scanning  ====================*/
+
+/* Scanning finds where a load step ends without decoding or allocating anything, so a stream only reads a step once all
+ * its bytes have arrived. It mirrors the readers below but checks every access and sets overflow rather than reading past
+ * the end. A type the readers reject stops the scan; the read then reports the error. */
+
+static void skipBytes(_dataInput* input, int count) {
+	if (count < 0 || count > input->end - input->cursor) {
+		input->overflow = 1;
+		input->cursor = input->end;
+	}
+	else input->cursor += count;
+}
+
+/* Skips count items of size bytes, failing rather than overflowing for corrupt counts. */
+static void skipItems(_dataInput* input, int count, int size) {
+	if (count > (input->end - input->cursor) / size) {
+		input->overflow = 1;
+		input->cursor = input->end;
+	}
+	else if (count > 0) input->cursor += count * size;
+}
+
+static int scanByte(_dataInput* input) {
+	if (input->cursor == input->end) {
+		input->overflow = 1;
+		return 0;
+	}
+	return *input->cursor++;
+}
+
+static int scanVarint(_dataInput* input) {
+	uint32_t value = 0;
+	int shift;
+	for (shift = 0; shift < 35; shift += 7) {
+		int b = scanByte(input);
+		value |= (uint32_t)(b & 0x7F) << shift;
+		if (!(b & 0x80)) break;
+	}
+	return (int)value;
+}
+
+static float scanFloat(_dataInput* input) {
+	union {
+		uint32_t intValue;
+		float floatValue;
+	} intToFloat;
+	int i;
+	intToFloat.intValue = 0;
+	for (i = 0; i < 4; ++i)
+		intToFloat.intValue = intToFloat.intValue << 8 | (uint32_t)scanByte(input);
+	return intToFloat.floatValue;
+}
+
+static void skipString(_dataInput* input) {
+	int length = scanVarint(input);
+	if (length > 0) skipBytes(input, length - 1);
+}
+
+static void skipCurve(_dataInput* input) {
+	if (scanByte(input) == SP_BINARY_CURVE_BEZIER) skipBytes(input, 16);
+}
+
+/* Each varint ends with the first byte without the high bit set, so only those are counted. */
+static void skipVarints(_dataInput* input, int count) {
+	const unsigned char* cursor = input->cursor;
+	const unsigned char* end = input->end;
+	while (count > 0 && cursor != end)
+		if (!(*cursor++ & 0x80)) --count;
+	if (count > 0) input->overflow = 1;
+	input->cursor = cursor;
+}
+
+/* Returns 0 for an attachment type the reader does not consume. */
+static int scanAttachment(_dataInput* input, int nonessential) {
+	int i, vertexCount;
+	skipString(input);
+	switch (scanByte(input)) {
+	case SP_ATTACHMENT_REGION:
+		skipString(input);
+		skipBytes(input, 7 * 4 + 4);
+		return 1;
+	case SP_ATTACHMENT_BOUNDING_BOX:
+		skipItems(input, scanVarint(input), 4);
+		return 1;
+	case SP_ATTACHMENT_MESH:
+		skipString(input);
+		skipItems(input, scanVarint(input), 4);
+		skipItems(input, scanVarint(input), 2);
+		skipItems(input, scanVarint(input), 4);
+		break;
+	case SP_ATTACHMENT_SKINNED_MESH:
+		skipString(input);
+		skipItems(input, scanVarint(input), 4);
+		skipItems(input, scanVarint(input), 2);
+		vertexCount = scanVarint(input);
+		for (i = 0; i < vertexCount && !input->overflow; ++i) {
+			float boneCount = scanFloat(input);
+			if (boneCount >= 1) {
+				skipItems(input, boneCount < 0x10000000 ? (int)boneCount : 0x10000000, 16);
+				if (!input->overflow) i += (int)boneCount * 4;
+			}
+		}
+		break;
+	default:
+		return 0;
+	}
+	skipBytes(input, 4);
+	scanVarint(input);
+	if (nonessential) {
+		skipVarints(input, scanVarint(input));
+		skipBytes(input, 8);
+	}
+	return 1;
+}
+
+/* Returns 0 if an attachment's type is unknown, leaving input before the rest of the skin. */
+static int scanSkin(_dataInput* input, int nonessential) {
+	int i, ii, slotCount = scanVarint(input);
+	for (i = 0; i < slotCount && !input->overflow; ++i) {
+		int attachmentsCount;
+		scanVarint(input);
+		attachmentsCount = scanVarint(input);
+		for (ii = 0; ii < attachmentsCount && !input->overflow; ++ii) {
+			skipString(input);
+			if (!scanAttachment(input, nonessential)) return 0;
+		}
+	}
+	return 1;
+}
+
+/* Skips the FFD timelines of one skin, after its index. */
+static void scanFFDSkin(_dataInput* input) {
+	int i, ii, frame, n = scanVarint(input);
+	for (i = 0; i < n && !input->overflow; ++i) {
+		int nn;
+		scanVarint(input);
+		nn = scanVarint(input);
+		for (ii = 0; ii < nn && !input->overflow; ++ii) {
+			int frameCount;
+			skipString(input);
+			frameCount = scanVarint(input);
+			for (frame = 0; frame < frameCount && !input->overflow; ++frame) {
+				int end;
+				skipBytes(input, 4);
+				end = scanVarint(input);
+				if (end != 0) {
+					scanVarint(input);
+					skipItems(input, end, 4);
+				}
+				if (frame < frameCount - 1) skipCurve(input);
+			}
+		}
+	}
+}
+
+/* Returns 0 if a timeline's type is unknown, leaving input before the rest of the animation. */
+static int scanAnimation(_dataInput* input) {
+	int i, ii, frame, n, nn;
+
+	/* Slot timelines. */
+	n = scanVarint(input);
+	for (i = 0; i < n && !input->overflow; ++i) {
+		scanVarint(input);
+		nn = scanVarint(input);
+		for (ii = 0; ii < nn && !input->overflow; ++ii) {
+			int type = scanByte(input), frameCount = scanVarint(input);
+			if (type != SP_BINARY_TIMELINE_ATTACHMENT && type != SP_BINARY_TIMELINE_COLOR) return 0;
+			for (frame = 0; frame < frameCount && !input->overflow; ++frame) {
+				skipBytes(input, 4);
+				if (type == SP_BINARY_TIMELINE_ATTACHMENT)
+					skipString(input);
+				else {
+					skipBytes(input, 4);
+					if (frame < frameCount - 1) skipCurve(input);
+				}
+			}
+		}
+	}
+
+	/* Bone timelines. */
+	n = scanVarint(input);
+	for (i = 0; i < n && !input->overflow; ++i) {
+		scanVarint(input);
+		nn = scanVarint(input);
+		for (ii = 0; ii < nn && !input->overflow; ++ii) {
+			int type = scanByte(input), frameCount = scanVarint(input), frameSize;
+			switch (type) {
+			case SP_BINARY_TIMELINE_ROTATE: frameSize = 8; break;
+			case SP_BINARY_TIMELINE_TRANSLATE:
+			case SP_BINARY_TIMELINE_SCALE: frameSize = 12; break;
+			case SP_BINARY_TIMELINE_FLIPX:
+			case SP_BINARY_TIMELINE_FLIPY:
+				skipItems(input, frameCount, 5);
+				continue;
+			default:
+				return 0;
+			}
+			for (frame = 0; frame < frameCount && !input->overflow; ++frame) {
+				skipBytes(input, frameSize);
+				if (frame < frameCount - 1) skipCurve(input);
+			}
+		}
+	}
+
+	/* IK constraint timelines. */
+	n = scanVarint(input);
+	for (i = 0; i < n && !input->overflow; ++i) {
+		int frameCount;
+		scanVarint(input);
+		frameCount = scanVarint(input);
+		for (frame = 0; frame < frameCount && !input->overflow; ++frame) {
+			skipBytes(input, 9);
+			if (frame < frameCount - 1) skipCurve(input);
+		}
+	}
+
+	/* FFD timelines. */
+	n = scanVarint(input);
+	for (i = 0; i < n && !input->overflow; ++i) {
+		scanVarint(input);
+		scanFFDSkin(input);
+	}
+
+	/* Draw order timeline. */
+	n = scanVarint(input);
+	for (i = 0; i < n && !input->overflow; ++i) {
+		nn = scanVarint(input);
+		for (ii = 0; ii < nn && !input->overflow; ++ii) {
+			scanVarint(input);
+			scanVarint(input);
+		}
+		skipBytes(input, 4);
+	}
+
+	/* Event timeline. */
+	n = scanVarint(input);
+	for (i = 0; i < n && !input->overflow; ++i) {
+		skipBytes(input, 4);
+		scanVarint(input);
+		scanVarint(input);
+		skipBytes(input, 4);
+		if (scanByte(input)) skipString(input);
+	}
+	return 1;
+}
+
+/* Advances input past the next step of load without changing load. Returns 0 if the step holds an attachment or timeline
+ * type that is unknown, so its end cannot be found. */
+static int scanStep(_dataInput* input, const _spLoad* load) {
+	switch (load->step) {
+	case SP_LOAD_HEADER:
+		skipString(input);
+		skipString(input);
+		skipBytes(input, 8);
+		if (scanByte(input)) skipString(input);
+		break;
+	case SP_LOAD_BONES_COUNT:
+	case SP_LOAD_IK_CONSTRAINTS_COUNT:
+	case SP_LOAD_SLOTS_COUNT:
+	case SP_LOAD_SKINS_COUNT:
+	case SP_LOAD_EVENTS_COUNT:
+	case SP_LOAD_ANIMATIONS_COUNT:
+		scanVarint(input);
+		break;
+	case SP_LOAD_BONE:
+		skipString(input);
+		scanVarint(input);
+		skipBytes(input, 6 * 4 + 4 + (load->nonessential ? 4 : 0));
+		break;
+	case SP_LOAD_IK_CONSTRAINT:
+		skipString(input);
+		skipVarints(input, scanVarint(input));
+		scanVarint(input);
+		skipBytes(input, 5);
+		break;
+	case SP_LOAD_SLOT:
+		skipString(input);
+		scanVarint(input);
+		skipBytes(input, 4);
+		skipString(input);
+		skipBytes(input, 1);
+		break;
+	case SP_LOAD_DEFAULT_SKIN:
+		return scanSkin(input, load->nonessential);
+	case SP_LOAD_SKIN:
+		skipString(input);
+		return scanSkin(input, load->nonessential);
+	case SP_LOAD_EVENT:
+		skipString(input);
+		scanVarint(input);
+		skipBytes(input, 4);
+		skipString(input);
+		break;
+	case SP_LOAD_ANIMATION:
+		skipString(input);
+		return scanAnimation(input);
+	case SP_LOAD_DONE:
+		break;
+	}
+	return 1;
+}
+
 /*====================  Internal class functions  ====================*/
 
 static void spSkeletonBinary_setError_(spSkeletonBinary* self, const char* value1, const char* value2) {
@@ -170,9 +890,28 @@ static void spSkeletonBinary_setError_(spSkeletonBinary* self, const char* value
 	MALLOC_STR(self->error, message);
 }
 
+/* Creates an attachment through the attachment loader, adding the loader's time to the skin being profiled. */
+static spAttachment* spSkeletonBinary_newAttachment_(spSkeletonBinary* self, spSkin* skin, spAttachmentType type,
+	const char* name, const char* path)
+{
+#ifdef SPINE_BINARY_PROFILE
+	spSkeletonBinarySkinProfile* skinProfile = SUB_CAST(_spSkeletonBinary, self)->currentSkin;
+	_spProfileMark mark;
+	markProfile(&mark, NULL);
+	spAttachment* attachment = spAttachmentLoader_newAttachment(self->attachmentLoader, skin, type, name, path);
+	if (skinProfile) {
+		addProfile(&skinProfile->attachmentLoader, &mark, NULL);
+		++skinProfile->attachmentsCount;
+	}
+	return attachment;
+#else
+	return spAttachmentLoader_newAttachment(self->attachmentLoader, skin, type, name, path);
+#endif
+}
+
 static spAttachment* spSkeletonBinary_readAttachment_(spSkeletonBinary* self, _dataInput* input,
 	spSkin* skin, int slotIndex, const char* attachmentName,
-	spSkeletonData* skeletonData, int /*bool*/ nonessential)
+	spSkeletonData* skeletonData, _spLoad* load)
 {
 	const char* name = readString(input);
 	int nameToBeFreed = name != NULL;
@@ -189,9 +928,12 @@ static spAttachment* spSkeletonBinary_readAttachment_(spSkeletonBinary* self, _d
 		char* path = readString(input);
 		if (path == NULL)MALLOC_STR(path, name);
 
-		spAttachment* attachment = spAttachmentLoader_newAttachment(self->attachmentLoader, skin, attachmentype, name, path);
+		spAttachment* attachment = spSkeletonBinary_newAttachment_(self, skin, attachmentype, name, path);
 		if (nameToBeFreed)FREE(name);
-		if (attachment == NULL) return NULL;
+		if (attachment == NULL) {
+			FREE(path);
+			return NULL;
+		}
 		spRegionAttachment* regionAttachment = SUB_CAST(spRegionAttachment, attachment);
 		regionAttachment->path = path;
 		regionAttachment->x = readFloat(input) * self->scale;
@@ -209,7 +951,7 @@ static spAttachment* spSkeletonBinary_readAttachment_(spSkeletonBinary* self, _d
 	}
 	case SP_ATTACHMENT_BOUNDING_BOX:
 	{
-		spAttachment* attachment = spAttachmentLoader_newAttachment(self->attachmentLoader, skin, attachmentype, name, NULL);
+		spAttachment* attachment = spSkeletonBinary_newAttachment_(self, skin, attachmentype, name, NULL);
 		if (nameToBeFreed)FREE(name);
 		if (attachment == NULL)return NULL;
 		spBoundingBoxAttachment* boxAttachment = SUB_CAST(spBoundingBoxAttachment, attachment);
@@ -221,26 +963,33 @@ static spAttachment* spSkeletonBinary_readAttachment_(spSkeletonBinary* self, _d
 		char* path = readString(input);
 		if (path == NULL)MALLOC_STR(path, name);
 
-		spAttachment* attachment = spAttachmentLoader_newAttachment(self->attachmentLoader, skin, attachmentype, name, path);
+		spAttachment* attachment = spSkeletonBinary_newAttachment_(self, skin, attachmentype, name, path);
 		if (nameToBeFreed)FREE(name);
-		if (attachment == NULL) return NULL;
+		if (attachment == NULL) {
+			FREE(path);
+			return NULL;
+		}
 
 		spMeshAttachment* meshAttachment = SUB_CAST(spMeshAttachment, attachment);
 		meshAttachment->path = path;
 
 		int uvCount = 0;
 		readFloatArray(input, self->scale, &meshAttachment->regionUVs, &uvCount);
-		readShortArray(input, &meshAttachment->triangles, &meshAttachment->trianglesCount);
+		readTriangles(input, load, attachment, &meshAttachment->triangles, &meshAttachment->trianglesCount);
 		readFloatArray(input, self->scale, &meshAttachment->vertices, &meshAttachment->verticesCount);
 		readColor(input, &meshAttachment->r, &meshAttachment->g, &meshAttachment->b, &meshAttachment->a);
 		meshAttachment->hullLength = readVarint(input, 1) * 2;
 
-		if (nonessential) {
+		if (load->nonessential && self->skipNonessential) {
+			skipVarints(input, readVarint(input, 1));
+			skipBytes(input, 8);
+		} else if (load->nonessential) {
 			readIntArray(input, &meshAttachment->edges, &meshAttachment->edgesCount);
 			meshAttachment->width = readFloat(input) * self->scale;
 			meshAttachment->height = readFloat(input) * self->scale;
 		}
 
+		shareMeshArrays(self, load, attachment);
 		spMeshAttachment_updateUVs(meshAttachment);
 
 		return attachment;
@@ -250,14 +999,18 @@ static spAttachment* spSkeletonBinary_readAttachment_(spSkeletonBinary* self, _d
 		char* path = readString(input);
 		if (path == NULL)MALLOC_STR(path, name);
 
-		spAttachment* attachment = spAttachmentLoader_newAttachment(self->attachmentLoader, skin, attachmentype, name, path);
+		spAttachment* attachment = spSkeletonBinary_newAttachment_(self, skin, attachmentype, name, path);
 		if (nameToBeFreed)FREE(name);
-		if (attachment == NULL) return NULL;
+		if (attachment == NULL) {
+			FREE(path);
+			return NULL;
+		}
 
 		spSkinnedMeshAttachment* skinnedMeshAttachment = SUB_CAST(spSkinnedMeshAttachment, attachment);
+		skinnedMeshAttachment->path = path;
 
 		readFloatArray(input, self->scale, &skinnedMeshAttachment->regionUVs, &skinnedMeshAttachment->uvsCount);
-		readShortArray(input, &skinnedMeshAttachment->triangles, &skinnedMeshAttachment->trianglesCount);
+		readTriangles(input, load, attachment, &skinnedMeshAttachment->triangles, &skinnedMeshAttachment->trianglesCount);
 
 		int vertexCount = readVarint(input, 1);
 
@@ -276,22 +1029,23 @@ static spAttachment* spSkeletonBinary_readAttachment_(spSkeletonBinary* self, _d
 		}
 
 		skinnedMeshAttachment->bonesCount = bones->size;
-		skinnedMeshAttachment->bones = bones->items;
+		skinnedMeshAttachment->bones = spIntArray_release(bones);
 		skinnedMeshAttachment->weightsCount = weights->size;
-		skinnedMeshAttachment->weights = weights->items;
-
-		FREE(bones);
-		FREE(weights);
+		skinnedMeshAttachment->weights = spFloatArray_release(weights);
 
 		readColor(input, &skinnedMeshAttachment->r, &skinnedMeshAttachment->g, &skinnedMeshAttachment->b, &skinnedMeshAttachment->a);
 		skinnedMeshAttachment->hullLength = readVarint(input, 1);
 
-		if (nonessential) {
+		if (load->nonessential && self->skipNonessential) {
+			skipVarints(input, readVarint(input, 1));
+			skipBytes(input, 8);
+		} else if (load->nonessential) {
 			readIntArray(input, &skinnedMeshAttachment->edges, &skinnedMeshAttachment->edgesCount);
 			skinnedMeshAttachment->width = readFloat(input) * self->scale;
 			skinnedMeshAttachment->height = readFloat(input) * self->scale;
 		}
 
+		shareMeshArrays(self, load, attachment);
 		spSkinnedMeshAttachment_updateUVs(skinnedMeshAttachment);
 
 		return attachment;
@@ -301,7 +1055,7 @@ static spAttachment* spSkeletonBinary_readAttachment_(spSkeletonBinary* self, _d
 	return NULL;
 }
 
-static spSkin* spSkeletonBinary_readSkin_(spSkeletonBinary* self, _dataInput* input, const char* skinName, spSkeletonData* skeletonData, int /*bool*/ nonessential)
+static spSkin* spSkeletonBinary_readSkin_(spSkeletonBinary* self, _dataInput* input, const char* skinName, spSkeletonData* skeletonData, _spLoad* load)
 {
 	int slotCount = readVarint(input, 1);
 	if (slotCount == 0) return NULL;
@@ -313,38 +1067,56 @@ static spSkin* spSkeletonBinary_readSkin_(spSkeletonBinary* self, _dataInput* in
 		int slotIndex = readVarint(input, 1);
 		for (int ii = 0, nn = readVarint(input, 1); ii < nn; ++ii) {
 			const char* name = readString(input);
-			spAttachment* attachment = spSkeletonBinary_readAttachment_(self, input, skin, slotIndex, name, skeletonData, nonessential);
+			spAttachment* attachment = spSkeletonBinary_readAttachment_(self, input, skin, slotIndex, name, skeletonData, load);
 			if (attachment) spSkin_addAttachment(skin, slotIndex, name, attachment);
 			FREE(name);
+			/* The data of an attachment the loader failed to create was not read, so the rest of the skin cannot be. */
+			if (self->attachmentLoader->error1) return skin;
 		}
 	}
 	return skin;
 }
 
+static void disposeTimelines(_spTimelineInlineArray* timelines) {
+	for (int i = 0; i < timelines->size; ++i) {
+		spTimeline_dispose(timelines->items[i]);
+	}
+	_spTimelineInlineArray_deinit(timelines);
+}
+
 static spAnimation* spSkeletonBinary_readAnimation_(spSkeletonBinary* self, const char* name,
-	_dataInput* input, spSkeletonData* skeletonData)
+	_dataInput* input, const _spLoad* load)
 {
-	spTimelineArray *timelines = spTimelineArray_create(256);
+	spSkeletonData* skeletonData = load->skeletonData;
+	/* Every section is prefixed with its timeline count, so the scratch array is grown once per section. */
+	_spTimelineInlineArray timelines;
+	_spTimelineInlineArray_init(&timelines);
 	float duration = 0;
+	PROFILE_MARK(group);
+	PROFILE_BEGIN(group, input);
 
 	/* Slot timelines. */
 	for (int i = 0, n = readVarint(input, 1); i < n; ++i) {
 		int slotIndex = readVarint(input, 1);
-		for (int ii = 0, nn = readVarint(input, 1); ii < nn; ++ii) {
+		int nn = readVarint(input, 1);
+		_spTimelineInlineArray_ensureCapacity(&timelines, timelines.size + nn);
+		for (int ii = 0; ii < nn; ++ii) {
 			int timelineType = readByte(input);
 			int frameCount = readVarint(input, 1);
 			switch (timelineType) {
 			case SP_BINARY_TIMELINE_ATTACHMENT:
 			{
-				spAttachmentTimeline* timeline = spAttachmentTimeline_create(frameCount);
+				spAttachmentTimeline* timeline = _spAttachmentTimeline_createResolved(frameCount);
 				timeline->slotIndex = slotIndex;
 				for (int frameIndex = 0; frameIndex < frameCount; ++frameIndex) {
 					float time = readFloat(input);
-					const char* attachmentName = readString(input);
-					spAttachmentTimeline_setFrame(timeline, frameIndex, time, attachmentName);
-					FREE(attachmentName);
+					/* The timeline takes the decoded name as is rather than copying it in setFrame. */
+					spAttachmentTimeline_setFrame(timeline, frameIndex, time, NULL);
+					timeline->attachmentNames[frameIndex] = readString(input);
 				}
-				spTimelineArray_add(timelines, SUPER(timeline));
+				/* The skins are read, so names are resolved to attachments once here rather than on every apply. */
+				_spAttachmentTimeline_resolve(timeline, skeletonData);
+				_spTimelineInlineArray_add(&timelines, SUPER(timeline));
 				duration = MAX(duration, timeline->frames[frameCount - 1]);
 				break;
 			}
@@ -359,21 +1131,26 @@ static spAnimation* spSkeletonBinary_readAnimation_(spSkeletonBinary* self, cons
 					spColorTimeline_setFrame(timeline, frameIndex, time, r, g, b, a);
 					if (frameIndex < frameCount - 1) readCurve(input, SUPER(timeline), frameIndex);
 				}
-				spTimelineArray_add(timelines, SUPER(SUPER(timeline)));
+				_spTimelineInlineArray_add(&timelines, SUPER(SUPER(timeline)));
 				duration = MAX(duration, timeline->frames[(frameCount * 5 - 5)]);
 				break;
 			}
 			default :
-				spTimelineArray_dispose(timelines);
+				disposeTimelines(&timelines);
+				spSkeletonBinary_setError_(self, "Invalid slot timeline type in animation: ", name);
 				return NULL;
 			} /*switch*/
 		}
 	}
 
+	PROFILE_GROUP(self, SP_BINARY_GROUP_SLOT_TIMELINES, group, input);
+
 	/* Bone timelines. */
 	for (int i = 0, n = readVarint(input, 1); i < n; ++i) {
 		int boneIndex = readVarint(input, 1);
-		for (int ii = 0, nn = readVarint(input, 1); ii < nn; ++ii) {
+		int nn = readVarint(input, 1);
+		_spTimelineInlineArray_ensureCapacity(&timelines, timelines.size + nn);
+		for (int ii = 0; ii < nn; ++ii) {
 			unsigned char timelineType = readByte(input);
 			int frameCount = readVarint(input, 1);
 			switch (timelineType) {
@@ -387,7 +1164,7 @@ static spAnimation* spSkeletonBinary_readAnimation_(spSkeletonBinary* self, cons
 					spRotateTimeline_setFrame(timeline, frameIndex, time, degrees);
 					if (frameIndex < frameCount - 1) readCurve(input, SUPER(timeline), frameIndex);
 				}
-				spTimelineArray_add(timelines, SUPER(SUPER(timeline)));
+				_spTimelineInlineArray_add(&timelines, SUPER(SUPER(timeline)));
 				duration = MAX(duration, timeline->frames[frameCount * 2 - 2]);
 				break;
 			}
@@ -418,7 +1195,7 @@ static spAnimation* spSkeletonBinary_readAnimation_(spSkeletonBinary* self, cons
 					if (frameIndex < frameCount - 1) readCurve(input, SUPER(timeline), frameIndex);
 				}
 
-				spTimelineArray_add(timelines, SUPER(SUPER(timeline)));
+				_spTimelineInlineArray_add(&timelines, SUPER(SUPER(timeline)));
 				duration = MAX(duration, timeline->frames[frameCount * 3 - 3]);
 				break;
 			}
@@ -432,19 +1209,24 @@ static spAnimation* spSkeletonBinary_readAnimation_(spSkeletonBinary* self, cons
 					int flip = readBoolean(input);
 					spFlipTimeline_setFrame(timeline, frameIndex, time, flip);
 				}
-				spTimelineArray_add(timelines, SUPER(timeline));
+				_spTimelineInlineArray_add(&timelines, SUPER(timeline));
 				duration = MAX(duration, timeline->frames[frameCount * 2 - 2]);
 				break;
 			}
 			default:
-				spTimelineArray_dispose(timelines);
+				disposeTimelines(&timelines);
+				spSkeletonBinary_setError_(self, "Invalid bone timeline type in animation: ", name);
 				return NULL;
 			} /*switch*/
 		}
 	}
 
+	PROFILE_GROUP(self, SP_BINARY_GROUP_BONE_TIMELINES, group, input);
+
 	/* IK constraint timelines. */
-	for (int i = 0, n = readVarint(input, 1); i < n; ++i) {
+	int ikCount = readVarint(input, 1);
+	_spTimelineInlineArray_ensureCapacity(&timelines, timelines.size + ikCount);
+	for (int i = 0; i < ikCount; ++i) {
 		int index = readVarint(input, 1);
 		int frameCount = readVarint(input, 1);
 		spIkConstraintTimeline* timeline = spIkConstraintTimeline_create(frameCount);
@@ -457,25 +1239,33 @@ static spAnimation* spSkeletonBinary_readAnimation_(spSkeletonBinary* self, cons
 			spIkConstraintTimeline_setFrame(timeline, frameIndex, time, mix, bendDirection);
 			if (frameIndex < frameCount - 1) readCurve(input, SUPER(timeline), frameIndex);
 		}
-		spTimelineArray_add(timelines, SUPER(SUPER(timeline)));
+		_spTimelineInlineArray_add(&timelines, SUPER(SUPER(timeline)));
 		duration = MAX(duration, timeline->frames[frameCount * 3 - 3]);
 	}
 
+	PROFILE_GROUP(self, SP_BINARY_GROUP_IK_TIMELINES, group, input);
+
 	/* FFD timelines. */
 	for (int i = 0, n = readVarint(input, 1); i < n; ++i) {
-		spSkin* skin = skeletonData->skins[readVarint(input, 1)];
+		int skinIndex = readVarint(input, 1);
+		if (load->skinIndices) skinIndex = load->skinIndices[skinIndex];
+		if (skinIndex < 0) {
+			/* The filter skipped the skin, so its attachments do not exist. */
+			scanFFDSkin(input);
+			continue;
+		}
+		spSkin* skin = skeletonData->skins[skinIndex];
 		for (int ii = 0, nn = readVarint(input, 1); ii < nn; ++ii) {
 			int slotIndex = readVarint(input, 1);
-			for (int iii = 0, nnn = readVarint(input, 1); iii < nnn; ++iii) {
+			int nnn = readVarint(input, 1);
+			_spTimelineInlineArray_ensureCapacity(&timelines, timelines.size + nnn);
+			for (int iii = 0; iii < nnn; ++iii) {
 				const char* attachmentName = readString(input);
 				int frameCount = readVarint(input, 1);
 
 				spAttachment* attachment = spSkin_getAttachment(skin, slotIndex, attachmentName);
 				if (attachment == NULL) {
-					for (int j = 0; j < timelines->size; ++j) {
-						spTimeline_dispose(timelines->items[j]);
-					}
-					spTimelineArray_dispose(timelines);
+					disposeTimelines(&timelines);
 					spSkeletonBinary_setError_(self, "Attachment not found: ", attachmentName);
 					FREE(attachmentName);
 					return NULL;
@@ -493,22 +1283,27 @@ static spAnimation* spSkeletonBinary_readAnimation_(spSkeletonBinary* self, cons
 				timeline->slotIndex = slotIndex;
 				timeline->attachment = attachment;
 
-				float* tempVertices = CALLOC(float, vertexCount);
+				_spFloatInlineArray tempVertices;
+				_spFloatInlineArray_init(&tempVertices);
+				_spFloatInlineArray_setSize(&tempVertices, vertexCount);
 
 				for (int frameIndex = 0; frameIndex < frameCount; ++frameIndex) {
 					float time = readFloat(input);
 					float* frameVertices = NULL;
 					int end = readVarint(input, 1);
+					/* Vertices outside the frame's range are zero, so the buffer is cleared for every frame. */
 					if (end == 0) {
 						if (attachment->type == SP_ATTACHMENT_MESH) {
 							frameVertices = SUB_CAST(spMeshAttachment, attachment)->vertices;
 						}
 						else {
-							frameVertices = tempVertices;
+							frameVertices = tempVertices.items;
+							memset(frameVertices, 0, vertexCount * sizeof(float));
 						}
 					}
 					else {
-						frameVertices = tempVertices;
+						frameVertices = tempVertices.items;
+						memset(frameVertices, 0, vertexCount * sizeof(float));
 						int start = readVarint(input, 1);
 						end += start;
 						for (int j = start; j < end; ++j) {
@@ -526,164 +1321,242 @@ static spAnimation* spSkeletonBinary_readAnimation_(spSkeletonBinary* self, cons
 					if (frameIndex < frameCount - 1) readCurve(input, SUPER(timeline), frameIndex);
 				}
 
-				FREE(tempVertices);
+				_spFloatInlineArray_deinit(&tempVertices);
 
-				spTimelineArray_add(timelines, SUPER(SUPER(timeline)));
+				_spTimelineInlineArray_add(&timelines, SUPER(SUPER(timeline)));
 				duration = MAX(duration, timeline->frames[frameCount - 1]);
 			}
 		}
 	}
 
+	PROFILE_GROUP(self, SP_BINARY_GROUP_FFD_TIMELINES, group, input);
+
 	/* Draw order timeline. */
 	int drawOrderCount = readVarint(input, 1);
 	if (drawOrderCount > 0) {
-		spDrawOrderTimeline* timeline = spDrawOrderTimeline_create(drawOrderCount, skeletonData->slotsCount);
+		/* Frames keep the file's slot index and offset pairs, which the timeline expands when applied. The pairs are counted
+		 * first so the timeline holds exactly them. */
+		_dataInput counter = *input;
+		int pairsCount = 0;
 		for (int i = 0; i < drawOrderCount; ++i) {
-			int offsetCount = readVarint(input, 1);
-			int* unchanged = MALLOC(int, skeletonData->slotsCount - offsetCount);
-			int* drawOrder = MALLOC(int, skeletonData->slotsCount);
-			memset(drawOrder, -1, skeletonData->slotsCount * sizeof(int));
-
-			int originalIndex = 0, unchangedIndex = 0;
-			for (int ii = 0; ii < offsetCount; ++ii) {
-				int slotIndex = readVarint(input, 1);
-				/* Collect unchanged items. */
-				while (originalIndex != slotIndex) {
-					unchanged[unchangedIndex++] = originalIndex++;
-				}
-				/* Set changed items. */
-				drawOrder[originalIndex + readVarint(input, 1)] = originalIndex;
-				++originalIndex;
-			}
-			/* Collect remaining unchanged items. */
-			while (originalIndex < skeletonData->slotsCount) {
-				unchanged[unchangedIndex++] = originalIndex++;
-			}
-			/* Fill in unchanged items. */
-			for (int ii = skeletonData->slotsCount - 1; ii >= 0; ii--) {
-				if (drawOrder[ii] == -1) drawOrder[ii] = unchanged[--unchangedIndex];
-			}
+			int offsetCount = scanVarint(&counter);
+			skipVarints(&counter, offsetCount * 2);
+			skipBytes(&counter, 4);
+			pairsCount += offsetCount;
+		}
 
-			FREE(unchanged);
+		spDrawOrderTimeline* timeline = _spDrawOrderTimeline_createCompact(drawOrderCount, skeletonData->slotsCount,
+			pairsCount);
+		_spIntInlineArray offsetsArray;
+		_spIntInlineArray_init(&offsetsArray);
+		int valid = 1;
+		for (int i = 0; i < drawOrderCount && valid; ++i) {
+			int offsetCount = readVarint(input, 1);
+			int* offsets = _spIntInlineArray_setSize(&offsetsArray, offsetCount * 2)->items;
+			for (int ii = 0; ii < offsetCount * 2; ++ii)
+				offsets[ii] = readVarint(input, 1);
 			float time = readFloat(input);
-			spDrawOrderTimeline_setFrame(timeline, i, time, drawOrder);
-			FREE(drawOrder);
+			valid = _spDrawOrderTimeline_setFrameOffsets(timeline, i, time, offsets, offsetCount);
+		}
+		_spIntInlineArray_deinit(&offsetsArray);
+		if (!valid) {
+			spTimeline_dispose(SUPER(timeline));
+			disposeTimelines(&timelines);
+			spSkeletonBinary_setError_(self, "Invalid draw order in animation: ", name);
+			return NULL;
 		}
-		spTimelineArray_add(timelines, SUPER(timeline));
+		_spTimelineInlineArray_add(&timelines, SUPER(timeline));
 		duration = MAX(duration, timeline->frames[drawOrderCount - 1]);
 	}
 
+	PROFILE_GROUP(self, SP_BINARY_GROUP_DRAW_ORDER, group, input);
+
 	/* Event timeline. */
 	int eventCount = readVarint(input, 1);
 	if (eventCount > 0) {
-		spEventTimeline* timeline = spEventTimeline_create(eventCount);
+		/* Events point at their data's default string. The strings they override are counted first and packed in one block. */
+		_dataInput counter = *input;
+		int stringsLength = 0;
+		for (int i = 0; i < eventCount; ++i) {
+			skipBytes(&counter, 4);
+			scanVarint(&counter);
+			scanVarint(&counter);
+			skipBytes(&counter, 4);
+			if (scanByte(&counter)) {
+				int length = scanVarint(&counter);
+				skipBytes(&counter, length - 1);
+				stringsLength += length;
+			}
+		}
+
+		spEventTimeline* timeline = _spEventTimeline_createShared(eventCount, stringsLength);
 		for (int i = 0; i < eventCount; ++i) {
 			float time = readFloat(input);
 			spEventData* eventData = skeletonData->events[readVarint(input, 1)];
-			spEvent* event = spEvent_create(eventData);
-			event->intValue = readVarint(input, 0);
-			event->floatValue = readFloat(input);
+			int intValue = readVarint(input, 0);
+			float floatValue = readFloat(input);
+			const char* stringValue = NULL;
+			int stringLength = -1;
 			if (readBoolean(input)) {
-				event->stringValue = readString(input);
-			}
-			else {
-				MALLOC_STR(event->stringValue, eventData->stringValue);
+				int length = readVarint(input, 1);
+				if (length > 0) {
+					stringValue = (const char*)input->cursor;
+					input->cursor += length - 1;
+				}
+				stringLength = MAX(length - 1, 0);
 			}
-			spEventTimeline_setFrame(timeline, i, time, event);
+			_spEventTimeline_setSharedFrame(timeline, i, time, eventData, intValue, floatValue, stringValue, stringLength);
 		}
-		spTimelineArray_add(timelines, SUPER(timeline));
-		duration = MAX(duration, timeline->frames[drawOrderCount - 1]);
+		_spTimelineInlineArray_add(&timelines, SUPER(timeline));
+		duration = MAX(duration, timeline->frames[eventCount - 1]);
 	}
 
-	spAnimation* animation = spAnimation_create(name, timelines->size);
+	PROFILE_GROUP(self, SP_BINARY_GROUP_EVENTS, group, input);
+
+	spAnimation* animation = spAnimation_create(name, timelines.size);
 	animation->duration = duration;
-	animation->timelines = timelines->items;
+	memcpy(animation->timelines, timelines.items, timelines.size * sizeof(spTimeline*));
+	_spTimelineInlineArray_deinit(&timelines);
 
 	return animation;
 }
 
-/*====================  end of internal class functions  ====================*/
+static void initLoad(_spLoad* load) {
+	load->skeletonData = spSkeletonData_create();
+	load->step = SP_LOAD_HEADER;
+	load->count = 0;
+	load->index = 0;
+	load->nonessential = 0;
+	load->skinIndices = NULL;
+	load->indices = NULL;
+	load->indexEntries = NULL;
+	load->indexEntriesCount = 0;
+	load->indexEntriesCapacity = 0;
+	load->meshArrays = NULL;
+	load->meshArraysCount = 0;
+	load->meshArraysCapacity = 0;
+}
 
-/*====================  public class functions  ====================*/
+static void disposeLoadIndices(_spLoad* load) {
+	if (load->indices) spUnsignedShortArray_dispose(load->indices);
+	FREE(load->indexEntries);
+	load->indices = NULL;
+	load->indexEntries = NULL;
+}
 
-spSkeletonBinary* spSkeletonBinary_createWithLoader(spAttachmentLoader* attachmentLoader) {
-	spSkeletonBinary* self = SUPER(NEW(_spSkeletonBinary));
-	self->scale = 1;
-	self->attachmentLoader = attachmentLoader;
-	return self;
+/* Disposes the part of the skeleton data an unfinished load has read. */
+static void disposeLoad(_spLoad* load) {
+	spSkeletonData* skeletonData = load->skeletonData;
+	FREE(load->skinIndices);
+	load->skinIndices = NULL;
+	disposeLoadIndices(load);
+	disposeLoadMeshArrays(load);
+	if (!skeletonData) return;
+	/* The default skin is only owned through skins once the skins count has been read. */
+	if (skeletonData->defaultSkin && skeletonData->skinsCount == 0) spSkin_dispose(skeletonData->defaultSkin);
+	spSkeletonData_dispose(skeletonData);
+	load->skeletonData = NULL;
 }
 
-spSkeletonBinary* spSkeletonBinary_create(spAtlas* atlas) {
-	spAtlasAttachmentLoader* attachmentLoader = spAtlasAttachmentLoader_create(atlas);
-	spSkeletonBinary* self = spSkeletonBinary_createWithLoader(SUPER(attachmentLoader));
-	SUB_CAST(_spSkeletonBinary, self)->ownsLoader = 1;
-	return self;
+/* Reads a section's item count and allocates its items, which the section's count then tracks as they are read. */
+static int readSectionCount(_dataInput* input, _spLoad* load, _spLoadStep itemStep, _spLoadStep nextStep) {
+	load->count = readVarint(input, 1);
+	load->index = 0;
+	load->step = load->count > 0 ? itemStep : nextStep;
+	return load->count;
 }
 
-void spSkeletonBinary_dispose(spSkeletonBinary* self) {
-	_spSkeletonBinary* internal = SUB_CAST(_spSkeletonBinary, self);
-	if (internal->ownsLoader) spAttachmentLoader_dispose(self->attachmentLoader);
-	FREE(self->error);
-	FREE(self);
+/* Returns whether the filter's list of names selects name. No list selects every name. */
+static int isSelected(const char* const* names, int namesCount, const char* name) {
+	int i;
+	if (!names) return 1;
+	for (i = 0; i < namesCount; ++i)
+		if (strcmp(names[i], name ? name : "") == 0) return 1;
+	return 0;
 }
 
-spSkeletonData* spSkeletonBinary_readSkeletonDataFile(spSkeletonBinary* self, const char* path) {
-	int length;
-	spSkeletonData* skeletonData;
-	const char* binary = _spUtil_readFile(path, &length);
-	if (length == 0 || !binary) {
-		spSkeletonBinary_setError_(self, "Unable to read skeleton file: ", path);
-		return NULL;
+/* The pool and its indices are one block, which the meshes of the read hold like a shared array. */
+typedef struct {
+	spSkeletonIndexPool super;
+	const spAllocator* allocator; /* Current while the pool was read, so that it is freed to the same context. */
+	int* refs; /* The meshes pointing into the pool, plus the binary or caller holding it. */
+} _spSkeletonIndexPool;
+
+/* Copies the indices read by a finished load into a pool and points each mesh at its own. */
+static spSkeletonIndexPool* createIndexPool(_spLoad* load) {
+	int count = load->indices->size;
+	_spSkeletonIndexPool* internal = (_spSkeletonIndexPool*)MALLOC(char,
+			sizeof(_spSkeletonIndexPool) + sizeof(unsigned short) * count);
+	spSkeletonIndexPool* pool = SUPER(internal);
+	unsigned short* indices = (unsigned short*)(internal + 1);
+	memcpy(indices, load->indices->items, sizeof(unsigned short) * count);
+	internal->allocator = spAllocator_getCurrent();
+	internal->refs = NEW(int);
+	*internal->refs = load->indexEntriesCount + 1;
+	CONST_CAST(unsigned short*, pool->indices) = indices;
+	CONST_CAST(int, pool->indicesCount) = count;
+	CONST_CAST(size_t, pool->bytes) = sizeof(unsigned short) * count;
+	CONST_CAST(size_t, pool->intBytes) = sizeof(int) * count;
+	for (int i = 0; i < load->indexEntriesCount; ++i) {
+		spAttachment* attachment = load->indexEntries[i].attachment;
+		const unsigned short* meshIndices = indices + load->indexEntries[i].offset;
+		if (attachment->type == SP_ATTACHMENT_MESH)
+			_spMeshAttachment_setPooledIndices(SUB_CAST(spMeshAttachment, attachment), meshIndices, internal, internal->refs);
+		else
+			_spSkinnedMeshAttachment_setPooledIndices(SUB_CAST(spSkinnedMeshAttachment, attachment), meshIndices, internal,
+					internal->refs);
 	}
-	skeletonData = spSkeletonBinary_readSkeletonData(self, (unsigned char*)binary, length);
-	FREE(binary);
-	return skeletonData;
+	disposeLoadIndices(load);
+	return pool;
 }
 
-spSkeletonData* spSkeletonBinary_readSkeletonData(spSkeletonBinary* self, const unsigned char* binary, const int length) {
-	int i, ii, nonessential;
-
-	spSkeletonData* skeletonData;
-	_spSkeletonBinary* internal = SUB_CAST(_spSkeletonBinary, self);
-
-	_dataInput* input = NEW(_dataInput);
-	input->cursor = binary;
-	input->end = binary + length;
-
-	FREE(self->error);
-	CONST_CAST(char*, self->error) = 0;
-
-	skeletonData = spSkeletonData_create();
-
-	skeletonData->hash = readString(input);
-	if (!strlen(skeletonData->hash)) {
-		FREE(skeletonData->hash);
-		skeletonData->hash = 0;
-	}
+static void setIndexPool(spSkeletonBinary* self, spSkeletonIndexPool* pool) {
+	if (self->indexPool) spSkeletonIndexPool_dispose(self->indexPool);
+	CONST_CAST(spSkeletonIndexPool*, self->indexPool) = pool;
+}
 
-	skeletonData->version = readString(input);
-	if (!strlen(skeletonData->version)) {
-		FREE(skeletonData->version);
-		skeletonData->version = 0;
-	}
+/* Reads the next step of load. Returns 0 with the error set if the data is invalid. */
+static int spSkeletonBinary_readStep_(spSkeletonBinary* self, _dataInput* input, _spLoad* load) {
+	spSkeletonData* skeletonData = load->skeletonData;
+	const _spLoadStep step = load->step;
+	int i, ok = 1;
+	PROFILE_MARK(mark);
+	PROFILE_MARK(item);
+	PROFILE_BEGIN(mark, input);
+
+	switch (step) {
+	case SP_LOAD_HEADER:
+		if (self->poolIndices) load->indices = spUnsignedShortArray_create(0);
+		skeletonData->hash = readString(input);
+		if (skeletonData->hash && !*skeletonData->hash) {
+			FREE(skeletonData->hash);
+			skeletonData->hash = 0;
+		}
 
-	skeletonData->width = readFloat(input);
-	skeletonData->height = readFloat(input);
+		skeletonData->version = readString(input);
+		if (skeletonData->version && !*skeletonData->version) {
+			FREE(skeletonData->version);
+			skeletonData->version = 0;
+		}
 
-	nonessential = readBoolean(input);
-	if (nonessential) {
-		/*CS runtime has SkeletonData.imagesPath, but not C*/
-		FREE(readString(input));
-	}
+		skeletonData->width = readFloat(input);
+		skeletonData->height = readFloat(input);
 
-	/* Bones. */
-	skeletonData->bonesCount = readVarint(input, 1);
-	skeletonData->bones = MALLOC(spBoneData*, skeletonData->bonesCount);
-	for (i = 0; i < skeletonData->bonesCount; ++i) {
+		load->nonessential = readBoolean(input);
+		if (load->nonessential) {
+			/*CS runtime has SkeletonData.imagesPath, but not C*/
+			skipString(input);
+		}
+		load->step = SP_LOAD_BONES_COUNT;
+		break;
 
+	case SP_LOAD_BONES_COUNT:
+		skeletonData->bones = MALLOC(spBoneData*, readSectionCount(input, load, SP_LOAD_BONE, SP_LOAD_IK_CONSTRAINTS_COUNT));
+		break;
+	case SP_LOAD_BONE: {
 		const char* name = readString(input);
 		int parentIndex = readVarint(input, 1) - 1;
-		spBoneData* parent = i == 0 ? NULL : skeletonData->bones[parentIndex];
+		spBoneData* parent = skeletonData->bonesCount == 0 ? NULL : skeletonData->bones[parentIndex];
 		spBoneData* boneData = spBoneData_create(name, parent);
 		FREE(name);
 		boneData->x = readFloat(input) * self->scale;
@@ -697,16 +1570,19 @@ spSkeletonData* spSkeletonBinary_readSkeletonData(spSkeletonBinary* self, const
 		boneData->inheritScale = readBoolean(input);
 		boneData->inheritRotation = readBoolean(input);
 
-		if (nonessential) {
-			int colour = readInt(input); /*skip bone colour*/
+		if (load->nonessential) {
+			readInt(input); /*skip bone colour*/
 		}
-		skeletonData->bones[i] = boneData;
+		skeletonData->bones[skeletonData->bonesCount] = boneData;
+		if (++skeletonData->bonesCount == load->count) load->step = SP_LOAD_IK_CONSTRAINTS_COUNT;
+		break;
 	}
 
-	/* IK constraints. */
-	skeletonData->ikConstraintsCount = readVarint(input, 1);
-	skeletonData->ikConstraints = MALLOC(spIkConstraintData*, skeletonData->ikConstraintsCount);
-	for (i = 0; i < skeletonData->ikConstraintsCount; ++i) {
+	case SP_LOAD_IK_CONSTRAINTS_COUNT:
+		skeletonData->ikConstraints = MALLOC(spIkConstraintData*,
+			readSectionCount(input, load, SP_LOAD_IK_CONSTRAINT, SP_LOAD_SLOTS_COUNT));
+		break;
+	case SP_LOAD_IK_CONSTRAINT: {
 		const char* name = readString(input);
 
 		spIkConstraintData* ikConstraintsData = spIkConstraintData_create(name);
@@ -714,20 +1590,22 @@ spSkeletonData* spSkeletonBinary_readSkeletonData(spSkeletonBinary* self, const
 
 		ikConstraintsData->bonesCount = readVarint(input, 1);
 		ikConstraintsData->bones = MALLOC(spBoneData*, ikConstraintsData->bonesCount);
-		for (ii = 0; ii < ikConstraintsData->bonesCount; ++ii) {
-			ikConstraintsData->bones[ii] = skeletonData->bones[readVarint(input, 1)];
+		for (i = 0; i < ikConstraintsData->bonesCount; ++i) {
+			ikConstraintsData->bones[i] = skeletonData->bones[readVarint(input, 1)];
 		}
-			
+
 		ikConstraintsData->target = skeletonData->bones[readVarint(input, 1)];
 		ikConstraintsData->mix = readFloat(input);
 		ikConstraintsData->bendDirection = readSByte(input);
-		skeletonData->ikConstraints[i] = ikConstraintsData;
+		skeletonData->ikConstraints[skeletonData->ikConstraintsCount] = ikConstraintsData;
+		if (++skeletonData->ikConstraintsCount == load->count) load->step = SP_LOAD_SLOTS_COUNT;
+		break;
 	}
 
-	/* Slots. */
-	skeletonData->slotsCount = readVarint(input, 1);
-	skeletonData->slots = MALLOC(spSlotData*, skeletonData->slotsCount);
-	for (i = 0; i < skeletonData->slotsCount; ++i) {
+	case SP_LOAD_SLOTS_COUNT:
+		skeletonData->slots = MALLOC(spSlotData*, readSectionCount(input, load, SP_LOAD_SLOT, SP_LOAD_DEFAULT_SKIN));
+		break;
+	case SP_LOAD_SLOT: {
 		const char* slotName = readString(input);
 		spBoneData* boneData = skeletonData->bones[readVarint(input, 1)];
 
@@ -736,71 +1614,419 @@ spSkeletonData* spSkeletonBinary_readSkeletonData(spSkeletonBinary* self, const
 		readColor(input, &slotData->r, &slotData->g, &slotData->b, &slotData->a);
 		slotData->attachmentName = readString(input);
 		slotData->additiveBlending = readBoolean(input);
-		skeletonData->slots[i] = slotData;
-	}
-
-	/* Default skin. */
-	skeletonData->defaultSkin = spSkeletonBinary_readSkin_(self, input, "default", skeletonData, nonessential);
-	if (self->attachmentLoader->error1) {
-		spSkeletonData_dispose(skeletonData);
-		spSkeletonBinary_setError_(self, self->attachmentLoader->error1, self->attachmentLoader->error2);
-		return NULL;
-	}
-
-	skeletonData->skinsCount = readVarint(input, 1);
-	if (skeletonData->defaultSkin) {
-		++skeletonData->skinsCount;
-	}
-
-	/* Skins. */
-	skeletonData->skins = MALLOC(spSkin*, skeletonData->skinsCount);
-	if (skeletonData->defaultSkin) {
-		skeletonData->skins[0] = skeletonData->defaultSkin;
+		skeletonData->slots[skeletonData->slotsCount] = slotData;
+		if (++skeletonData->slotsCount == load->count) load->step = SP_LOAD_DEFAULT_SKIN;
+		break;
 	}
 
-	for (i = skeletonData->defaultSkin ? 1 : 0; i < skeletonData->skinsCount; ++i) {
+	case SP_LOAD_DEFAULT_SKIN:
+		PROFILE_BEGIN_SKIN(self, "default", item, input);
+		skeletonData->defaultSkin = spSkeletonBinary_readSkin_(self, input, "default", skeletonData, load);
+		PROFILE_END_SKIN(self, item, input);
+		if (self->attachmentLoader->error1) {
+			spSkeletonBinary_setError_(self, self->attachmentLoader->error1, self->attachmentLoader->error2);
+			ok = 0;
+			break;
+		}
+		load->step = SP_LOAD_SKINS_COUNT;
+		break;
+	case SP_LOAD_SKINS_COUNT:
+		load->count = readVarint(input, 1);
+		if (skeletonData->defaultSkin) ++load->count;
+		skeletonData->skins = MALLOC(spSkin*, load->count);
+		if (skeletonData->defaultSkin) skeletonData->skins[skeletonData->skinsCount++] = skeletonData->defaultSkin;
+		load->index = skeletonData->skinsCount;
+		if (self->filter.skinNames) {
+			load->skinIndices = MALLOC(int, load->count);
+			if (skeletonData->defaultSkin) load->skinIndices[0] = 0;
+		}
+		load->step = load->index < load->count ? SP_LOAD_SKIN : SP_LOAD_EVENTS_COUNT;
+		break;
+	case SP_LOAD_SKIN: {
 		const char* skinName = readString(input);
-		spSkin* skin = spSkeletonBinary_readSkin_(self, input, skinName, skeletonData, nonessential);
+		if (!isSelected(self->filter.skinNames, self->filter.skinNamesCount, skinName)) {
+			if (!scanSkin(input, load->nonessential)) {
+				/* The rest of the skin, and so everything after it, cannot be found. */
+				spSkeletonBinary_setError_(self, "Invalid attachment type in skin: ", skinName);
+				FREE(skinName);
+				ok = 0;
+				break;
+			}
+			FREE(skinName);
+			load->skinIndices[load->index] = -1;
+			if (++load->index == load->count) load->step = SP_LOAD_EVENTS_COUNT;
+			break;
+		}
+		if (load->skinIndices) load->skinIndices[load->index] = skeletonData->skinsCount;
+		PROFILE_BEGIN_SKIN(self, skinName, item, input);
+		spSkin* skin = spSkeletonBinary_readSkin_(self, input, skinName, skeletonData, load);
+		PROFILE_END_SKIN(self, item, input);
 		FREE(skinName);
 		if (self->attachmentLoader->error1) {
-			spSkeletonData_dispose(skeletonData);
+			if (skin) spSkin_dispose(skin);
 			spSkeletonBinary_setError_(self, self->attachmentLoader->error1, self->attachmentLoader->error2);
-			return NULL;
+			ok = 0;
+			break;
 		}
-		skeletonData->skins[i] = skin;
+		skeletonData->skins[skeletonData->skinsCount++] = skin;
+		if (++load->index == load->count) load->step = SP_LOAD_EVENTS_COUNT;
+		break;
 	}
 
-	/* Events. */
-	skeletonData->eventsCount = readVarint(input, 1);
-	skeletonData->events = MALLOC(spEventData*, skeletonData->eventsCount);
-	for (i = 0; i < skeletonData->eventsCount; ++i) {
+	case SP_LOAD_EVENTS_COUNT:
+		skeletonData->events = MALLOC(spEventData*, readSectionCount(input, load, SP_LOAD_EVENT, SP_LOAD_ANIMATIONS_COUNT));
+		break;
+	case SP_LOAD_EVENT: {
 		const char* name = readString(input);
 		spEventData* eventData = spEventData_create(name);
 		FREE(name);
 		eventData->intValue = readVarint(input, 0);
 		eventData->floatValue = readFloat(input);
 		eventData->stringValue = readString(input);
-		skeletonData->events[i] = eventData;
+		skeletonData->events[skeletonData->eventsCount] = eventData;
+		if (++skeletonData->eventsCount == load->count) load->step = SP_LOAD_ANIMATIONS_COUNT;
+		break;
 	}
 
-	/* Animations. */
-	skeletonData->animationsCount = readVarint(input, 1);
-	skeletonData->animations = MALLOC(spAnimation*, skeletonData->animationsCount);
-	for (i = 0; i < skeletonData->animationsCount; ++i) {
+	case SP_LOAD_ANIMATIONS_COUNT:
+		skeletonData->animations = MALLOC(spAnimation*, readSectionCount(input, load, SP_LOAD_ANIMATION, SP_LOAD_DONE));
+		PROFILE_RESERVE_ANIMATIONS(self, load->count);
+		break;
+	case SP_LOAD_ANIMATION: {
 		const char* name = readString(input);
-		spAnimation* animation = spSkeletonBinary_readAnimation_(self, name, input, skeletonData);
-		FREE(name);
+		if (!isSelected(self->filter.animationNames, self->filter.animationNamesCount, name)) {
+			if (!scanAnimation(input)) {
+				spSkeletonBinary_setError_(self, "Invalid timeline type in animation: ", name);
+				FREE(name);
+				ok = 0;
+				break;
+			}
+			FREE(name);
+			if (++load->index == load->count) load->step = SP_LOAD_DONE;
+			break;
+		}
+		PROFILE_BEGIN_ANIMATION(self, skeletonData->animationsCount, name, item, input);
+		spAnimation* animation = spSkeletonBinary_readAnimation_(self, name, input, load);
+		PROFILE_END_ANIMATION(self, item, input);
 		if (!animation) {
-			FREE(input);
-			/*the remaining still not allocated.*/
-			skeletonData->animationsCount = i;
-			spSkeletonData_dispose(skeletonData);
-			spSkeletonBinary_setError_(self, "Animation corrupted: ", name);
+			/* Keep the more specific error set while reading the animation. */
+			if (!self->error) spSkeletonBinary_setError_(self, "Animation corrupted: ", name);
+			FREE(name);
+			ok = 0;
+			break;
+		}
+		FREE(name);
+		skeletonData->animations[skeletonData->animationsCount++] = animation;
+		if (++load->index == load->count) load->step = SP_LOAD_DONE;
+		break;
+	}
+
+	case SP_LOAD_DONE:
+		break;
+	}
+
+	/* Skipping scans, which stops at the end of the data rather than reading past it. */
+	if (ok && input->overflow) {
+		spSkeletonBinary_setError_(self, "Skeleton data corrupted.", NULL);
+		ok = 0;
+	}
+	if (load->step == SP_LOAD_DONE) {
+		FREE(load->skinIndices);
+		load->skinIndices = NULL;
+		if (load->indices) setIndexPool(self, createIndexPool(load));
+		disposeLoadMeshArrays(load);
+	}
+	PROFILE_STEP(self, step, mark, input);
+	return ok;
+}
+
+static spSkeletonData* spSkeletonBinary_readSkeletonData_(spSkeletonBinary* self, const unsigned char* binary, const int length) {
+	_dataInput input;
+	_spLoad load;
+
+	input.cursor = binary;
+	input.end = binary + length;
+	input.overflow = 0;
+	PROFILE_RESET(self);
+
+	FREE(self->error);
+	CONST_CAST(char*, self->error) = 0;
+	setIndexPool(self, NULL);
+	resetMeshStats(self);
+
+	initLoad(&load);
+	while (load.step != SP_LOAD_DONE) {
+		if (!spSkeletonBinary_readStep_(self, &input, &load)) {
+			disposeLoad(&load);
 			return NULL;
 		}
-		skeletonData->animations[i] = animation;
 	}
+	return load.skeletonData;
+}
+
+/*====================  end of internal class functions  ====================*/
+
+/*====================  public class functions  ====================*/
+
+spSkeletonBinary* spSkeletonBinary_createWithLoader(spAttachmentLoader* attachmentLoader) {
+	spSkeletonBinary* self = SUPER(NEW(_spSkeletonBinary));
+	self->scale = 1;
+	self->attachmentLoader = attachmentLoader;
+	CONST_CAST(const spAllocator*, self->allocator) = spAllocator_getCurrent();
+	return self;
+}
+
+spSkeletonBinary* spSkeletonBinary_create(spAtlas* atlas) {
+	spAtlasAttachmentLoader* attachmentLoader = spAtlasAttachmentLoader_create(atlas);
+	spSkeletonBinary* self = spSkeletonBinary_createWithLoader(SUPER(attachmentLoader));
+	SUB_CAST(_spSkeletonBinary, self)->ownsLoader = 1;
+	return self;
+}
+
+spSkeletonBinary* spSkeletonBinary_createWithLoaderAndAllocator(spAttachmentLoader* attachmentLoader, const spAllocator* allocator) {
+	const spAllocator* previous = spAllocator_setCurrent(allocator);
+	spSkeletonBinary* self = spSkeletonBinary_createWithLoader(attachmentLoader);
+	spAllocator_setCurrent(previous);
+	return self;
+}
+
+spSkeletonBinary* spSkeletonBinary_createWithAllocator(spAtlas* atlas, const spAllocator* allocator) {
+	const spAllocator* previous = spAllocator_setCurrent(allocator);
+	spSkeletonBinary* self = spSkeletonBinary_create(atlas);
+	spAllocator_setCurrent(previous);
+	return self;
+}
+
+void spSkeletonBinary_dispose(spSkeletonBinary* self) {
+	_spSkeletonBinary* internal = SUB_CAST(_spSkeletonBinary, self);
+	const spAllocator* previous = spAllocator_setCurrent(self->allocator);
+	if (internal->ownsLoader) spAttachmentLoader_dispose(self->attachmentLoader);
+	setIndexPool(self, NULL);
+#ifdef SPINE_BINARY_PROFILE
+	disposeProfile((spSkeletonBinaryProfile*)self->profile);
+#endif
+	FREE(self->error);
+	FREE(self);
+	spAllocator_setCurrent(previous);
+}
+
+spSkeletonData* spSkeletonBinary_readSkeletonDataFile(spSkeletonBinary* self, const char* path) {
+	int length;
+	spSkeletonData* skeletonData;
+	const spAllocator* previous = spAllocator_setCurrent(self->allocator);
+	const char* binary = _spUtil_readFile(path, &length);
+	if (length == 0 || !binary) {
+		spSkeletonBinary_setError_(self, "Unable to read skeleton file: ", path);
+		spAllocator_setCurrent(previous);
+		return NULL;
+	}
+	skeletonData = spSkeletonBinary_readSkeletonData_(self, (unsigned char*)binary, length);
+	FREE(binary);
+	spAllocator_setCurrent(previous);
+	return skeletonData;
+}
+
+spSkeletonData* spSkeletonBinary_readSkeletonData(spSkeletonBinary* self, const unsigned char* binary, const int length) {
+	const spAllocator* previous = spAllocator_setCurrent(self->allocator);
+	spSkeletonData* skeletonData = spSkeletonBinary_readSkeletonData_(self, binary, length);
+	spAllocator_setCurrent(previous);
+	return skeletonData;
+}
+
+void spSkeletonBinary_disposeSkeletonData(spSkeletonBinary* self, spSkeletonData* skeletonData) {
+	const spAllocator* previous;
+	if (self->allocator && !self->allocator->deallocate) return; /* Dropped with the dispose-only context. */
+	previous = spAllocator_setCurrent(self->allocator);
+	spSkeletonData_dispose(skeletonData);
+	spAllocator_setCurrent(previous);
+}
+
+spSkeletonIndexPool* spSkeletonBinary_releaseIndexPool(spSkeletonBinary* self) {
+	spSkeletonIndexPool* pool = self->indexPool;
+	CONST_CAST(spSkeletonIndexPool*, self->indexPool) = NULL;
+	return pool;
+}
+
+/*====================  Index pool  ====================*/
+
+void spSkeletonIndexPool_dispose(spSkeletonIndexPool* self) {
+	_spSkeletonIndexPool* internal = SUB_CAST(_spSkeletonIndexPool, self);
+	const spAllocator* previous;
+	if (internal->allocator && !internal->allocator->deallocate) return;
+	previous = spAllocator_setCurrent(internal->allocator);
+	_spMeshArray_release(internal, internal->refs);
+	spAllocator_setCurrent(previous);
+}
+
+const unsigned short* spSkeletonIndexPool_getIndices(const spAttachment* attachment) {
+	if (attachment->type == SP_ATTACHMENT_MESH)
+		return _spMeshAttachment_getPooledIndices(SUB_CAST(const spMeshAttachment, attachment));
+	if (attachment->type == SP_ATTACHMENT_SKINNED_MESH)
+		return _spSkinnedMeshAttachment_getPooledIndices(SUB_CAST(const spSkinnedMeshAttachment, attachment));
+	return NULL;
+}
+
+int spSkeletonIndexPool_getOffset(const spSkeletonIndexPool* self, const spAttachment* attachment) {
+	const unsigned short* indices = spSkeletonIndexPool_getIndices(attachment);
+	if (!indices || indices < self->indices || indices > self->indices + self->indicesCount) return -1;
+	return (int)(indices - self->indices);
+}
+
+/*====================  Stream  ====================*/
+
+/* Reads every complete step in [data, data + length) and returns the number of bytes read. */
+static int readCompleteSteps(_spSkeletonBinaryStream* self, const unsigned char* data, int length) {
+	spSkeletonBinary* binary = self->super.binary;
+	_dataInput input;
+	input.cursor = data;
+	input.end = data + length;
+	input.overflow = 0;
+	while (self->load.step != SP_LOAD_DONE) {
+		_dataInput scan = input;
+		int scanned = scanStep(&scan, &self->load);
+		if (scan.overflow) {
+			/* Wait for half as much again before scanning the incomplete step again, so a large step is scanned a bounded
+			 * number of times however small the chunks are. */
+			int remaining = (int)(input.end - input.cursor);
+			self->scanLength = remaining + remaining / 2 + 1;
+			break;
+		}
+		if (!scanned) {
+			spSkeletonBinary_setError_(binary, "Skeleton data corrupted.", NULL);
+			self->failed = 1;
+			break;
+		}
+		if (!spSkeletonBinary_readStep_(binary, &input, &self->load)) {
+			self->failed = 1;
+			break;
+		}
+		if (input.cursor != scan.cursor) {
+			spSkeletonBinary_setError_(binary, "Skeleton data corrupted.", NULL);
+			self->failed = 1;
+			break;
+		}
+	}
+	CONST_CAST(int, self->super.bytesRead) += (int)(input.cursor - data);
+	return (int)(input.cursor - data);
+}
+
+static void bufferBytes(_spSkeletonBinaryStream* self, const unsigned char* data, int length) {
+	int bufferedBytes = self->super.bufferedBytes;
+	if (length <= 0) return;
+	if (bufferedBytes + length > self->bufferCapacity) {
+		self->bufferCapacity = MAX(self->bufferCapacity * 2, bufferedBytes + length);
+		self->buffer = REALLOC(self->buffer, unsigned char, self->bufferCapacity);
+	}
+	memcpy(self->buffer + bufferedBytes, data, length);
+	CONST_CAST(int, self->super.bufferedBytes) = bufferedBytes + length;
+	if (self->super.bufferedBytes > self->super.peakBufferedBytes)
+		CONST_CAST(int, self->super.peakBufferedBytes) = self->super.bufferedBytes;
+}
+
+static void readBufferedSteps(_spSkeletonBinaryStream* self) {
+	int read = readCompleteSteps(self, self->buffer, self->super.bufferedBytes);
+	int remaining = self->load.step == SP_LOAD_DONE ? 0 : self->super.bufferedBytes - read;
+	memmove(self->buffer, self->buffer + read, remaining);
+	CONST_CAST(int, self->super.bufferedBytes) = remaining;
+}
+
+spSkeletonBinaryStream* spSkeletonBinaryStream_create(spSkeletonBinary* binary) {
+	const spAllocator* previous = spAllocator_setCurrent(binary->allocator);
+	_spSkeletonBinaryStream* self = NEW(_spSkeletonBinaryStream);
+	CONST_CAST(spSkeletonBinary*, self->super.binary) = binary;
+	FREE(binary->error);
+	CONST_CAST(char*, binary->error) = 0;
+	setIndexPool(binary, NULL);
+	resetMeshStats(binary);
+	PROFILE_RESET(binary);
+	initLoad(&self->load);
+	spAllocator_setCurrent(previous);
+	return SUPER(self);
+}
+
+void spSkeletonBinaryStream_dispose(spSkeletonBinaryStream* self) {
+	_spSkeletonBinaryStream* internal = SUB_CAST(_spSkeletonBinaryStream, self);
+	const spAllocator* previous = spAllocator_setCurrent(self->binary->allocator);
+	disposeLoad(&internal->load);
+	FREE(internal->buffer);
+	FREE(internal);
+	spAllocator_setCurrent(previous);
+}
+
+int spSkeletonBinaryStream_feed(spSkeletonBinaryStream* self, const unsigned char* data, int length) {
+	_spSkeletonBinaryStream* internal = SUB_CAST(_spSkeletonBinaryStream, self);
+	const spAllocator* previous;
+	if (internal->failed) return -1;
+	if (internal->load.step == SP_LOAD_DONE) return 0;
+
+	previous = spAllocator_setCurrent(self->binary->allocator);
+	if (self->bufferedBytes == 0) {
+		/* Read straight from the chunk and keep only the incomplete step at its end. */
+		int read = readCompleteSteps(internal, data, length);
+		if (!internal->failed && internal->load.step != SP_LOAD_DONE) bufferBytes(internal, data + read, length - read);
+	}
+	else {
+		bufferBytes(internal, data, length);
+		if (self->bufferedBytes >= internal->scanLength) readBufferedSteps(internal);
+	}
+	spAllocator_setCurrent(previous);
+
+	if (internal->failed) return -1;
+	return internal->load.step == SP_LOAD_DONE ? 0 : 1;
+}
 
-	FREE(input);
+spSkeletonData* spSkeletonBinaryStream_finish(spSkeletonBinaryStream* self) {
+	_spSkeletonBinaryStream* internal = SUB_CAST(_spSkeletonBinaryStream, self);
+	const spAllocator* previous = spAllocator_setCurrent(self->binary->allocator);
+	spSkeletonData* skeletonData = NULL;
+	/* Steps may have been held back waiting for more data. */
+	if (!internal->failed && internal->load.step != SP_LOAD_DONE && self->bufferedBytes > 0) readBufferedSteps(internal);
+	if (!internal->failed && internal->load.step != SP_LOAD_DONE) {
+		spSkeletonBinary_setError_(self->binary, "Skeleton data truncated.", NULL);
+		internal->failed = 1;
+	}
+	if (!internal->failed) {
+		skeletonData = internal->load.skeletonData;
+		internal->load.skeletonData = NULL;
+	}
+	spAllocator_setCurrent(previous);
 	return skeletonData;
 }
+
+#ifdef SPINE_BINARY_PROFILE
+
+static void reportProfileEntry(FILE* file, const char* kind, const char* parent, const spSkeletonBinaryProfileEntry* entry) {
+	fprintf(file, "%s\t%s%s%s\t%.6f\t%d\t%d\t%lu\n", kind, parent ? parent : "", parent ? "/" : "", entry->name ? entry->name : "",
+		entry->seconds, entry->bytes, entry->allocations, (unsigned long)entry->allocatedBytes);
+}
+
+void spSkeletonBinary_reportProfile(const spSkeletonBinary* self, FILE* file) {
+	const spSkeletonBinaryProfile* profile = self->profile;
+	int i, ii;
+	if (!profile) {
+		fprintf(file, "No profile, nothing has been read.\n");
+		return;
+	}
+	fprintf(file, "kind\tname\tseconds\tbytes\tallocations\tallocated_bytes\n");
+	reportProfileEntry(file, "total", NULL, &profile->total);
+	for (i = 0; i < SP_BINARY_SECTIONS_COUNT; ++i)
+		reportProfileEntry(file, "section", NULL, &profile->sections[i]);
+	for (i = 0; i < profile->skinsCount; ++i) {
+		reportProfileEntry(file, "skin", NULL, &profile->skins[i].super);
+		reportProfileEntry(file, "skin", profile->skins[i].super.name, &profile->skins[i].attachmentLoader);
+	}
+	for (i = 0; i < profile->animationsCount; ++i) {
+		reportProfileEntry(file, "animation", NULL, &profile->animations[i].super);
+		for (ii = 0; ii < SP_BINARY_GROUPS_COUNT; ++ii)
+			reportProfileEntry(file, "animation", profile->animations[i].super.name, &profile->animations[i].groups[ii]);
+	}
+}
+
+#else
+
+void spSkeletonBinary_reportProfile(const spSkeletonBinary* self, FILE* file) {
+	UNUSED(self);
+	fprintf(file, "Load profiling is disabled, build with SPINE_BINARY_PROFILE.\n");
+}
+
+#endif /* SPINE_BINARY_PROFILE */
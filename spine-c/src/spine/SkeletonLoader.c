@@ -0,0 +1,404 @@
+#include <spine/SkeletonLoader.h>
+#include <spine/AtlasIndex.h>
+#include <spine/SkeletonBinary.h>
+#include <spine/Thread.h>
+#include <spine/extension.h>
+
+#define DEFAULT_MAX_LOADS 64
+
+typedef struct _spSkeletonLoad {
+	spSkeletonLoad super;
+	struct _spSkeletonLoad* next; /* In the queue or the ended list. */
+	struct _spSkeletonLoad* previousLoad; /* In the list of loads not yet released. */
+	struct _spSkeletonLoad* nextLoad;
+	char* path;
+	const unsigned char* data;
+	int length;
+	float scale;
+	spSkeletonLoadPriority priority;
+	spSkeletonLoadCallback callback;
+	spSkeletonData* skeletonData;
+	int /*bool*/ cancelled; /* While running. */
+	int /*bool*/ released; /* While running, the worker frees the load when it ends. */
+	int /*bool*/ reported; /* Taken from the ended list by spSkeletonLoader_update. */
+} _spSkeletonLoad;
+
+typedef struct {
+	spSkeletonLoader super;
+	spAtlasIndex* atlasIndex; /* Shared by the workers' attachment loaders. */
+	_spThread** threads;
+	_spMutex* mutex; /* Guards everything below and the state of every load. */
+	_spCondition* loadQueued;
+	_spCondition* loadEnded;
+	_spSkeletonLoad* queue; /* Needed loads, then prefetches. */
+	_spSkeletonLoad* ended;
+	_spSkeletonLoad* lastEnded;
+	_spSkeletonLoad* loads;
+	int queuedCount, runningCount;
+	int /*bool*/ stopping;
+} _spSkeletonLoader;
+
+/* The loader's memory comes from the default context, like the workers', whatever is current on the calling thread. */
+#define ENTER_DEFAULT_CONTEXT() const spAllocator* previous = spAllocator_setCurrent(0)
+#define LEAVE_DEFAULT_CONTEXT() spAllocator_setCurrent(previous)
+
+static void setState (_spSkeletonLoad* load, spSkeletonLoadState state) {
+	CONST_CAST(spSkeletonLoadState, load->super.state) = state;
+}
+
+static void disposeLoad (_spSkeletonLoad* load) {
+	if (load->skeletonData) spSkeletonData_dispose(load->skeletonData);
+	FREE(load->super.error);
+	FREE(load->path);
+	FREE(load);
+}
+
+/**/
+
+/* Queued behind the loads of the same or a higher priority. */
+static void enqueue (_spSkeletonLoader* self, _spSkeletonLoad* load) {
+	_spSkeletonLoad** link = &self->queue;
+	while (*link && (*link)->priority >= load->priority)
+		link = &(*link)->next;
+	load->next = *link;
+	*link = load;
+	self->queuedCount++;
+}
+
+static void dequeue (_spSkeletonLoader* self, _spSkeletonLoad* load) {
+	_spSkeletonLoad** link = &self->queue;
+	while (*link != load)
+		link = &(*link)->next;
+	*link = load->next;
+	load->next = 0;
+	self->queuedCount--;
+}
+
+static void addLoad (_spSkeletonLoader* self, _spSkeletonLoad* load) {
+	load->nextLoad = self->loads;
+	if (self->loads) self->loads->previousLoad = load;
+	self->loads = load;
+}
+
+static void removeLoad (_spSkeletonLoader* self, _spSkeletonLoad* load) {
+	if (load->previousLoad)
+		load->previousLoad->nextLoad = load->nextLoad;
+	else
+		self->loads = load->nextLoad;
+	if (load->nextLoad) load->nextLoad->previousLoad = load->previousLoad;
+}
+
+static void removeEnded (_spSkeletonLoader* self, _spSkeletonLoad* load) {
+	_spSkeletonLoad* previousEnded = 0;
+	_spSkeletonLoad** link = &self->ended;
+	while (*link != load) {
+		previousEnded = *link;
+		link = &(*link)->next;
+	}
+	*link = load->next;
+	if (self->lastEnded == load) self->lastEnded = previousEnded;
+}
+
+/* Moves a load that is no longer queued or running to the ended list. */
+static void endLoad (_spSkeletonLoader* self, _spSkeletonLoad* load, spSkeletonLoadState state) {
+	if (state != SP_SKELETON_LOAD_DONE && load->skeletonData) {
+		spSkeletonData_dispose(load->skeletonData);
+		load->skeletonData = 0;
+	}
+	setState(load, state);
+	load->next = 0;
+	if (self->lastEnded)
+		self->lastEnded->next = load;
+	else
+		self->ended = load;
+	self->lastEnded = load;
+	_spCondition_broadcast(self->loadEnded);
+}
+
+/**/
+
+/* Reads and parses a load with the worker's binary, without the lock. */
+static void runLoad (_spSkeletonLoader* self, _spSkeletonLoad* load, spSkeletonBinary* binary) {
+	unsigned char* file = 0;
+	const unsigned char* data = load->data;
+	int length = load->length, cancelled;
+
+	if (load->path) {
+		file = (unsigned char*)_spUtil_readFile(load->path, &length);
+		if (!file || length == 0) {
+			FREE(file);
+			CONST_CAST(char*, load->super.error) = MALLOC(char, strlen(load->path) + 31);
+			strcpy(CONST_CAST(char*, load->super.error), "Unable to read skeleton file: ");
+			strcat(CONST_CAST(char*, load->super.error), load->path);
+			return;
+		}
+		data = file;
+	}
+
+	/* Skip parsing if the load was cancelled while its file was read. */
+	_spMutex_lock(self->mutex);
+	cancelled = load->cancelled || load->released;
+	_spMutex_unlock(self->mutex);
+
+	if (!cancelled) {
+		binary->scale = load->scale;
+		load->skeletonData = spSkeletonBinary_readSkeletonData(binary, data, length);
+		if (!load->skeletonData) MALLOC_STR(CONST_CAST(char*, load->super.error), binary->error);
+	}
+	FREE(file);
+}
+
+static void runWorker (void* userData) {
+	_spSkeletonLoader* self = (_spSkeletonLoader*)userData;
+	/* Each worker has its own binary and attachment loader, which keep per read state. */
+	spAtlasAttachmentLoader* attachmentLoader = spAtlasAttachmentLoader_createWithIndex(self->atlasIndex);
+	spSkeletonBinary* binary = spSkeletonBinary_createWithLoader(SUPER(attachmentLoader));
+
+	_spMutex_lock(self->mutex);
+	for (;;) {
+		_spSkeletonLoad* load;
+		while (!self->queue && !self->stopping)
+			_spCondition_wait(self->loadQueued, self->mutex);
+		if (self->stopping) break;
+
+		load = self->queue;
+		dequeue(self, load);
+		self->runningCount++;
+		setState(load, SP_SKELETON_LOAD_RUNNING);
+		_spMutex_unlock(self->mutex);
+
+		runLoad(self, load, binary);
+
+		_spMutex_lock(self->mutex);
+		self->runningCount--;
+		if (load->released)
+			disposeLoad(load);
+		else if (load->cancelled)
+			endLoad(self, load, SP_SKELETON_LOAD_CANCELLED);
+		else
+			endLoad(self, load, load->skeletonData ? SP_SKELETON_LOAD_DONE : SP_SKELETON_LOAD_FAILED);
+	}
+	_spMutex_unlock(self->mutex);
+
+	spSkeletonBinary_dispose(binary);
+	spAttachmentLoader_dispose(SUPER(attachmentLoader));
+}
+
+/**/
+
+spSkeletonLoader* spSkeletonLoader_create (spAtlas* atlas, int threadsCount, int maxLoads) {
+	_spSkeletonLoader* self;
+	int i;
+	ENTER_DEFAULT_CONTEXT();
+
+	if (threadsCount <= 0) threadsCount = MAX(_spThread_getProcessorsCount() - 1, 1);
+	self = NEW(_spSkeletonLoader);
+	CONST_CAST(int, self->super.maxLoads) = maxLoads > 0 ? maxLoads : DEFAULT_MAX_LOADS;
+	self->super.scale = 1;
+	self->atlasIndex = spAtlasIndex_create(atlas);
+	self->mutex = _spMutex_create();
+	self->loadQueued = _spCondition_create();
+	self->loadEnded = _spCondition_create();
+	self->threads = MALLOC(_spThread*, threadsCount);
+	for (i = 0; i < threadsCount; ++i) {
+		_spThread* thread = _spThread_create(runWorker, self);
+		if (!thread) break;
+		self->threads[CONST_CAST(int, self->super.threadsCount)++] = thread;
+	}
+
+	LEAVE_DEFAULT_CONTEXT();
+	if (self->super.threadsCount == 0) {
+		spSkeletonLoader_dispose(SUPER(self));
+		return 0;
+	}
+	return SUPER(self);
+}
+
+void spSkeletonLoader_dispose (spSkeletonLoader* self) {
+	_spSkeletonLoader* internal = SUB_CAST(_spSkeletonLoader, self);
+	int i;
+	ENTER_DEFAULT_CONTEXT();
+
+	_spMutex_lock(internal->mutex);
+	internal->stopping = 1;
+	_spCondition_broadcast(internal->loadQueued);
+	_spMutex_unlock(internal->mutex);
+	for (i = 0; i < self->threadsCount; ++i)
+		_spThread_join(internal->threads[i]);
+
+	/* Queued, ended and unreported loads are all in the list of loads not yet released. */
+	while (internal->loads) {
+		_spSkeletonLoad* load = internal->loads;
+		internal->loads = load->nextLoad;
+		disposeLoad(load);
+	}
+
+	_spCondition_dispose(internal->loadEnded);
+	_spCondition_dispose(internal->loadQueued);
+	_spMutex_dispose(internal->mutex);
+	spAtlasIndex_dispose(internal->atlasIndex);
+	FREE(internal->threads);
+	FREE(internal);
+	LEAVE_DEFAULT_CONTEXT();
+}
+
+static spSkeletonLoad* submit (_spSkeletonLoader* self, _spSkeletonLoad* load) {
+	_spMutex_lock(self->mutex);
+	if (self->queuedCount + self->runningCount >= self->super.maxLoads) {
+		_spSkeletonLoad* last = self->queue;
+		while (last && last->next)
+			last = last->next;
+		if (load->priority != SP_SKELETON_LOAD_NEEDED || !last || last->priority != SP_SKELETON_LOAD_PREFETCH) {
+			_spMutex_unlock(self->mutex);
+			disposeLoad(load);
+			return 0;
+		}
+		dequeue(self, last);
+		endLoad(self, last, SP_SKELETON_LOAD_CANCELLED);
+	}
+	addLoad(self, load);
+	enqueue(self, load);
+	_spCondition_signal(self->loadQueued);
+	_spMutex_unlock(self->mutex);
+	return SUPER(load);
+}
+
+static _spSkeletonLoad* createLoad (_spSkeletonLoader* self, spSkeletonLoadPriority priority, spSkeletonLoadCallback callback,
+		void* userData) {
+	_spSkeletonLoad* load = NEW(_spSkeletonLoad);
+	load->super.userData = userData;
+	load->scale = self->super.scale;
+	load->priority = priority;
+	load->callback = callback;
+	return load;
+}
+
+spSkeletonLoad* spSkeletonLoader_loadFile (spSkeletonLoader* self, const char* path, spSkeletonLoadPriority priority,
+		spSkeletonLoadCallback callback, void* userData) {
+	_spSkeletonLoad* load;
+	spSkeletonLoad* result;
+	ENTER_DEFAULT_CONTEXT();
+	load = createLoad(SUB_CAST(_spSkeletonLoader, self), priority, callback, userData);
+	MALLOC_STR(load->path, path);
+	result = submit(SUB_CAST(_spSkeletonLoader, self), load);
+	LEAVE_DEFAULT_CONTEXT();
+	return result;
+}
+
+spSkeletonLoad* spSkeletonLoader_loadData (spSkeletonLoader* self, const unsigned char* data, int length,
+		spSkeletonLoadPriority priority, spSkeletonLoadCallback callback, void* userData) {
+	_spSkeletonLoad* load;
+	spSkeletonLoad* result;
+	ENTER_DEFAULT_CONTEXT();
+	load = createLoad(SUB_CAST(_spSkeletonLoader, self), priority, callback, userData);
+	load->data = data;
+	load->length = length;
+	result = submit(SUB_CAST(_spSkeletonLoader, self), load);
+	LEAVE_DEFAULT_CONTEXT();
+	return result;
+}
+
+spSkeletonLoadState spSkeletonLoader_getState (spSkeletonLoader* self, spSkeletonLoad* load) {
+	_spSkeletonLoader* internal = SUB_CAST(_spSkeletonLoader, self);
+	spSkeletonLoadState state;
+	_spMutex_lock(internal->mutex);
+	state = load->state;
+	_spMutex_unlock(internal->mutex);
+	return state;
+}
+
+void spSkeletonLoader_setPriority (spSkeletonLoader* self, spSkeletonLoad* load, spSkeletonLoadPriority priority) {
+	_spSkeletonLoader* internal = SUB_CAST(_spSkeletonLoader, self);
+	_spSkeletonLoad* internalLoad = SUB_CAST(_spSkeletonLoad, load);
+	_spMutex_lock(internal->mutex);
+	internalLoad->priority = priority;
+	if (load->state == SP_SKELETON_LOAD_QUEUED) {
+		dequeue(internal, internalLoad);
+		enqueue(internal, internalLoad);
+	}
+	_spMutex_unlock(internal->mutex);
+}
+
+spSkeletonLoadState spSkeletonLoader_wait (spSkeletonLoader* self, spSkeletonLoad* load) {
+	_spSkeletonLoader* internal = SUB_CAST(_spSkeletonLoader, self);
+	_spSkeletonLoad* internalLoad = SUB_CAST(_spSkeletonLoad, load);
+	spSkeletonLoadState state;
+	_spMutex_lock(internal->mutex);
+	if (load->state == SP_SKELETON_LOAD_QUEUED) {
+		dequeue(internal, internalLoad);
+		internalLoad->next = internal->queue;
+		internal->queue = internalLoad;
+		internal->queuedCount++;
+	}
+	while (load->state == SP_SKELETON_LOAD_QUEUED || load->state == SP_SKELETON_LOAD_RUNNING)
+		_spCondition_wait(internal->loadEnded, internal->mutex);
+	state = load->state;
+	_spMutex_unlock(internal->mutex);
+	return state;
+}
+
+int spSkeletonLoader_cancel (spSkeletonLoader* self, spSkeletonLoad* load) {
+	_spSkeletonLoader* internal = SUB_CAST(_spSkeletonLoader, self);
+	_spSkeletonLoad* internalLoad = SUB_CAST(_spSkeletonLoad, load);
+	int cancelled = 1;
+	ENTER_DEFAULT_CONTEXT();
+	_spMutex_lock(internal->mutex);
+	if (load->state == SP_SKELETON_LOAD_QUEUED) {
+		dequeue(internal, internalLoad);
+		endLoad(internal, internalLoad, SP_SKELETON_LOAD_CANCELLED);
+	} else if (load->state == SP_SKELETON_LOAD_RUNNING)
+		internalLoad->cancelled = 1;
+	else
+		cancelled = 0;
+	_spMutex_unlock(internal->mutex);
+	LEAVE_DEFAULT_CONTEXT();
+	return cancelled;
+}
+
+int spSkeletonLoader_update (spSkeletonLoader* self) {
+	_spSkeletonLoader* internal = SUB_CAST(_spSkeletonLoader, self);
+	int count = 0;
+	/* Taken one at a time, since a callback can release any load, including ones that ended after it. */
+	for (;;) {
+		_spSkeletonLoad* load;
+		_spMutex_lock(internal->mutex);
+		load = internal->ended;
+		if (load) {
+			internal->ended = load->next;
+			if (!internal->ended) internal->lastEnded = 0;
+			load->next = 0;
+			load->reported = 1;
+		}
+		_spMutex_unlock(internal->mutex);
+		if (!load) break;
+		++count;
+		if (load->callback) load->callback(SUPER(load), load->super.userData);
+	}
+	return count;
+}
+
+spSkeletonData* spSkeletonLoader_release (spSkeletonLoader* self, spSkeletonLoad* load) {
+	_spSkeletonLoader* internal = SUB_CAST(_spSkeletonLoader, self);
+	_spSkeletonLoad* internalLoad = SUB_CAST(_spSkeletonLoad, load);
+	spSkeletonData* skeletonData = 0;
+	ENTER_DEFAULT_CONTEXT();
+	_spMutex_lock(internal->mutex);
+	removeLoad(internal, internalLoad);
+	switch (load->state) {
+	case SP_SKELETON_LOAD_QUEUED:
+		dequeue(internal, internalLoad);
+		disposeLoad(internalLoad);
+		break;
+	case SP_SKELETON_LOAD_RUNNING:
+		internalLoad->released = 1;
+		break;
+	default:
+		if (!internalLoad->reported) removeEnded(internal, internalLoad);
+		skeletonData = internalLoad->skeletonData;
+		internalLoad->skeletonData = 0;
+		disposeLoad(internalLoad);
+	}
+	_spMutex_unlock(internal->mutex);
+	LEAVE_DEFAULT_CONTEXT();
+	return skeletonData;
+}
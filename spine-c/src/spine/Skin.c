@@ -0,0 +1,182 @@
+/******************************************************************************
+ * Spine Runtimes Software License
+ * Version 2.1
+ *
+ * Copyright (c) 2013, Esoteric Software
+ * All rights reserved.
+ *
+ * You are granted a perpetual, non-exclusive, non-sublicensable and
+ * non-transferable license to install, execute and perform the Spine Runtimes
+ * Software (the "Software") solely for internal use. Without the written
+ * permission of Esoteric Software (typically granted by licensing Spine), you
+ * may not (a) modify, translate, adapt or otherwise create derivative works,
+ * improvements of the Software or develop new applications using the Software
+ * or (b) remove, delete, alter or obscure any trademarks or any copyright,
+ * trademark, patent or other intellectual property or proprietary rights
+ * notices on or in the Software, including any copy thereof. Redistributions
+ * in binary or source form must include this license and terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ESOTERIC SOFTWARE "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL ESOTERIC SOFTARE BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+#include <spine/Skin.h>
+#include <spine/extension.h>
+
+typedef struct _Entry _Entry;
+struct _Entry {
+	int slotIndex;
+	const char* name;
+	spAttachment* attachment;
+	_Entry* next;
+	unsigned int hash;
+};
+
+static unsigned int _Entry_hash (int slotIndex, const char* name) {
+	/* FNV-1a over the name, seeded with the slot index. */
+	unsigned int hash = 2166136261u ^ (unsigned int)slotIndex;
+	hash *= 16777619u;
+	for (; *name; ++name) {
+		hash ^= (unsigned char)*name;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+_Entry* _Entry_create (int slotIndex, const char* name, spAttachment* attachment) {
+	_Entry* self = NEW(_Entry);
+	self->slotIndex = slotIndex;
+	MALLOC_STR(self->name, name);
+	self->attachment = attachment;
+	self->hash = _Entry_hash(slotIndex, name);
+	return self;
+}
+
+void _Entry_dispose (_Entry* self) {
+	spAttachment_dispose(self->attachment);
+	FREE(self->name);
+	FREE(self);
+}
+
+/**/
+
+typedef struct {
+	spSkin super;
+	_Entry* entries;
+
+	/* Open addressing index over entries, keyed on (slotIndex, name). Capacity is a power of two, at most half full. */
+	_Entry** index;
+	int indexCapacity;
+	int indexCount;
+} _spSkin;
+
+/* Puts an entry in the index, replacing an entry with the same key so the most recently added attachment wins. */
+static void _spSkin_indexEntry (_spSkin* self, _Entry* entry) {
+	unsigned int mask = (unsigned int)self->indexCapacity - 1;
+	unsigned int i = entry->hash & mask;
+	for (;; i = (i + 1) & mask) {
+		_Entry* existing = self->index[i];
+		if (!existing) {
+			self->index[i] = entry;
+			self->indexCount++;
+			return;
+		}
+		if (existing->hash == entry->hash && existing->slotIndex == entry->slotIndex && strcmp(existing->name, entry->name) == 0) {
+			self->index[i] = entry;
+			return;
+		}
+	}
+}
+
+static void _spSkin_growIndex (_spSkin* self) {
+	_Entry** oldIndex = self->index;
+	int i, oldCapacity = self->indexCapacity;
+	self->indexCapacity = oldCapacity ? oldCapacity << 1 : 16;
+	self->index = CALLOC(_Entry*, self->indexCapacity);
+	self->indexCount = 0;
+	for (i = 0; i < oldCapacity; ++i)
+		if (oldIndex[i]) _spSkin_indexEntry(self, oldIndex[i]);
+	FREE(oldIndex);
+}
+
+spSkin* spSkin_create (const char* name) {
+	spSkin* self = SUPER(NEW(_spSkin));
+	MALLOC_STR(self->name, name);
+	return self;
+}
+
+void spSkin_dispose (spSkin* self) {
+	_Entry* entry = SUB_CAST(_spSkin, self)->entries;
+	while (entry) {
+		_Entry* nextEntry = entry->next;
+		_Entry_dispose(entry);
+		entry = nextEntry;
+	}
+
+	FREE(SUB_CAST(_spSkin, self)->index);
+	FREE(self->name);
+	FREE(self);
+}
+
+void spSkin_addAttachment (spSkin* self, int slotIndex, const char* name, spAttachment* attachment) {
+	_spSkin* internal = SUB_CAST(_spSkin, self);
+	_Entry* newEntry = _Entry_create(slotIndex, name, attachment);
+	newEntry->next = internal->entries;
+	internal->entries = newEntry;
+
+	if ((internal->indexCount + 1) * 2 > internal->indexCapacity) _spSkin_growIndex(internal);
+	_spSkin_indexEntry(internal, newEntry);
+}
+
+spAttachment* spSkin_getAttachment (const spSkin* self, int slotIndex, const char* name) {
+	const _spSkin* internal = SUB_CAST(_spSkin, self);
+	unsigned int hash, mask, i;
+	if (!internal->index) return 0;
+	hash = _Entry_hash(slotIndex, name);
+	mask = (unsigned int)internal->indexCapacity - 1;
+	for (i = hash & mask; internal->index[i]; i = (i + 1) & mask) {
+		const _Entry* entry = internal->index[i];
+		if (entry->hash == hash && entry->slotIndex == slotIndex && strcmp(entry->name, name) == 0) return entry->attachment;
+	}
+	return 0;
+}
+
+const char* spSkin_getAttachmentName (const spSkin* self, int slotIndex, int attachmentIndex) {
+	const _Entry* entry = SUB_CAST(_spSkin, self)->entries;
+	int i = 0;
+	while (entry) {
+		if (entry->slotIndex == slotIndex) {
+			if (i == attachmentIndex) return entry->name;
+			i++;
+		}
+		entry = entry->next;
+	}
+	return 0;
+}
+
+void _spSkin_forEachAttachment (const spSkin* self, void* userData,
+		void (*visit) (void* userData, int slotIndex, const char* name, spAttachment* attachment)) {
+	const _Entry* entry;
+	for (entry = SUB_CAST(_spSkin, self)->entries; entry; entry = entry->next)
+		visit(userData, entry->slotIndex, entry->name, entry->attachment);
+}
+
+void spSkin_attachAll (const spSkin* self, spSkeleton* skeleton, const spSkin* oldSkin) {
+	const _Entry *entry = SUB_CAST(_spSkin, oldSkin)->entries;
+	while (entry) {
+		spSlot *slot = skeleton->slots[entry->slotIndex];
+		if (slot->attachment == entry->attachment) {
+			spAttachment *attachment = spSkin_getAttachment(self, entry->slotIndex, entry->name);
+			if (attachment) spSlot_setAttachment(slot, attachment);
+		}
+		entry = entry->next;
+	}
+}
@@ -0,0 +1,269 @@
+#include <spine/Skinning.h>
+#include <spine/extension.h>
+#include <string.h>
+
+#if !defined(SPINE_NO_SIMD) && (defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+#define SP_SKINNING_SSE
+#include <xmmintrin.h>
+#endif
+
+#define LANES 4
+#define TRANSFORM_SIZE 8
+/* Blocks of a batch skinned for every instance before moving on, so the chunk stays in cache. 256 vertices of 4 influences
+ * take 16KB. */
+#define CHUNK_BLOCKS 64
+
+/* Each array holds one row of verticesCount lanes per influence, at [influence * verticesCount + vertex]. */
+typedef struct {
+	int influencesCount; /* Of every vertex of the group. */
+	int verticesCount; /* Padded to whole blocks. */
+	int* outputs; /* Index of each vertex's x in the world vertices, -1 for padding. */
+	int* ffdOffsets; /* Index of each vertex's first x in the FFD vertices, which has 2 floats per influence. */
+	int* transforms; /* Offset of the bone's transform in the palette. */
+	float* x;
+	float* y;
+	float* weights;
+} _spSkinningGroup;
+
+typedef struct {
+	spSkinningMesh super;
+	int groupsCount;
+	_spSkinningGroup* groups;
+} _spSkinningMesh;
+
+/**/
+
+spSkinningPalette* spSkinningPalette_create (int bonesCount) {
+	spSkinningPalette* self = NEW(spSkinningPalette);
+	CONST_CAST(int, self->bonesCount) = bonesCount;
+	CONST_CAST(float*, self->transforms) = MALLOC_ALIGNED(float, (bonesCount > 0 ? bonesCount : 1) * TRANSFORM_SIZE, 16);
+	memset(self->transforms, 0, sizeof(float) * (bonesCount > 0 ? bonesCount : 1) * TRANSFORM_SIZE);
+	return self;
+}
+
+void spSkinningPalette_dispose (spSkinningPalette* self) {
+	FREE(self->transforms);
+	FREE(self);
+}
+
+void spSkinningPalette_update (spSkinningPalette* self, const spSkeleton* skeleton) {
+	int i, n = MIN(self->bonesCount, skeleton->bonesCount);
+	for (i = 0; i < n; ++i) {
+		const spBone* bone = skeleton->bones[i];
+		float* transform = self->transforms + i * TRANSFORM_SIZE;
+		transform[0] = bone->m00;
+		transform[1] = bone->m01;
+		transform[2] = bone->m10;
+		transform[3] = bone->m11;
+		transform[4] = bone->worldX;
+		transform[5] = bone->worldY;
+	}
+}
+
+/**/
+
+static void _spSkinningGroup_init (_spSkinningGroup* self, int influencesCount, int verticesCount) {
+	int size = influencesCount * verticesCount, i;
+	self->influencesCount = influencesCount;
+	self->verticesCount = verticesCount;
+	self->outputs = MALLOC(int, verticesCount);
+	for (i = 0; i < verticesCount; ++i)
+		self->outputs[i] = -1;
+	self->ffdOffsets = CALLOC(int, verticesCount);
+	if (size == 0) size = 1;
+	/* Padding lanes use bone 0 and FFD offset 0 with a weight of 0, so they skin to finite values which are discarded. */
+	self->transforms = CALLOC(int, size);
+	self->x = MALLOC_ALIGNED(float, size, 16);
+	self->y = MALLOC_ALIGNED(float, size, 16);
+	self->weights = MALLOC_ALIGNED(float, size, 16);
+	memset(self->x, 0, sizeof(float) * size);
+	memset(self->y, 0, sizeof(float) * size);
+	memset(self->weights, 0, sizeof(float) * size);
+}
+
+spSkinningMesh* spSkinningMesh_create (const spSkinnedMeshAttachment* attachment) {
+	_spSkinningMesh* self = NEW(_spSkinningMesh);
+	int maxInfluences = 0, vertices = 0, padded = 0, i, v, b, f;
+	int* groupOf; /* Per influence count, the group index or -1. */
+	int* filled;
+
+	for (v = 0; v < attachment->bonesCount; v += attachment->bones[v] + 1) {
+		maxInfluences = MAX(maxInfluences, attachment->bones[v]);
+		++vertices;
+	}
+	groupOf = MALLOC(int, maxInfluences + 1);
+	filled = CALLOC(int, maxInfluences + 1);
+	for (v = 0; v < attachment->bonesCount; v += attachment->bones[v] + 1)
+		++filled[attachment->bones[v]];
+	for (i = 0; i <= maxInfluences; ++i)
+		groupOf[i] = filled[i] ? self->groupsCount++ : -1;
+
+	self->groups = CALLOC(_spSkinningGroup, self->groupsCount > 0 ? self->groupsCount : 1);
+	for (i = 0; i <= maxInfluences; ++i) {
+		int count;
+		if (groupOf[i] < 0) continue;
+		count = (filled[i] + LANES - 1) / LANES * LANES;
+		_spSkinningGroup_init(self->groups + groupOf[i], i, count);
+		padded += i * count;
+		filled[i] = 0;
+	}
+
+	/* Vertices keep their order within a group, so runs of them are written contiguously. */
+	for (v = 0, b = 0, f = 0, i = 0; v < attachment->bonesCount; ++i) {
+		int influences = attachment->bones[v], k;
+		_spSkinningGroup* group = self->groups + groupOf[influences];
+		int lane = filled[influences]++;
+		group->outputs[lane] = i * 2;
+		group->ffdOffsets[lane] = f;
+		++v;
+		for (k = 0; k < influences; ++k, ++v, b += 3, f += 2) {
+			int index = k * group->verticesCount + lane;
+			group->transforms[index] = attachment->bones[v] * TRANSFORM_SIZE;
+			group->x[index] = attachment->weights[b];
+			group->y[index] = attachment->weights[b + 1];
+			group->weights[index] = attachment->weights[b + 2];
+		}
+	}
+
+	CONST_CAST(int, self->super.worldVerticesCount) = vertices * 2;
+	CONST_CAST(int, self->super.influencesCount) = attachment->weightsCount / 3;
+	CONST_CAST(int, self->super.paddedInfluencesCount) = padded;
+	FREE(groupOf);
+	FREE(filled);
+	return SUPER(self);
+}
+
+void spSkinningMesh_dispose (spSkinningMesh* self) {
+	_spSkinningMesh* internal = SUB_CAST(_spSkinningMesh, self);
+	int i;
+	for (i = 0; i < internal->groupsCount; ++i) {
+		_spSkinningGroup* group = internal->groups + i;
+		FREE(group->outputs);
+		FREE(group->transforms);
+		FREE(group->ffdOffsets);
+		FREE(group->x);
+		FREE(group->y);
+		FREE(group->weights);
+	}
+	FREE(internal->groups);
+	FREE(internal);
+}
+
+/**/
+
+#ifdef SP_SKINNING_SSE
+
+static void skinBlock (const _spSkinningGroup* group, int vertex, const spSkinningInstance* instance) {
+	const float* palette = instance->palette->transforms;
+	const float* ffd = instance->ffd;
+	const int* outputs = group->outputs + vertex;
+	float* worldVertices = instance->worldVertices;
+	__m128 wx = _mm_setzero_ps(), wy = _mm_setzero_ps(), low, high;
+	int k;
+
+	for (k = 0; k < group->influencesCount; ++k) {
+		int index = k * group->verticesCount + vertex;
+		const int* transforms = group->transforms + index;
+		const float* t0 = palette + transforms[0];
+		const float* t1 = palette + transforms[1];
+		const float* t2 = palette + transforms[2];
+		const float* t3 = palette + transforms[3];
+		/* Unaligned loads: MALLOC_ALIGNED only aligns when the allocator in use can, so no buffer is known to be aligned. */
+		__m128 m00 = _mm_loadu_ps(t0), m01 = _mm_loadu_ps(t1), m10 = _mm_loadu_ps(t2), m11 = _mm_loadu_ps(t3);
+		__m128 worldX, worldY, vx, vy, weight;
+
+		_MM_TRANSPOSE4_PS(m00, m01, m10, m11);
+		low = _mm_unpacklo_ps(_mm_loadu_ps(t0 + 4), _mm_loadu_ps(t1 + 4));
+		high = _mm_unpacklo_ps(_mm_loadu_ps(t2 + 4), _mm_loadu_ps(t3 + 4));
+		worldX = _mm_movelh_ps(low, high);
+		worldY = _mm_movehl_ps(high, low);
+
+		vx = _mm_loadu_ps(group->x + index);
+		vy = _mm_loadu_ps(group->y + index);
+		if (ffd) {
+			const int* offsets = group->ffdOffsets + vertex;
+			const float* f0 = ffd + offsets[0] + k * 2;
+			const float* f1 = ffd + offsets[1] + k * 2;
+			const float* f2 = ffd + offsets[2] + k * 2;
+			const float* f3 = ffd + offsets[3] + k * 2;
+			vx = _mm_add_ps(vx, _mm_setr_ps(f0[0], f1[0], f2[0], f3[0]));
+			vy = _mm_add_ps(vy, _mm_setr_ps(f0[1], f1[1], f2[1], f3[1]));
+		}
+		weight = _mm_loadu_ps(group->weights + index);
+		wx = _mm_add_ps(wx, _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, m00), _mm_mul_ps(vy, m01)), worldX), weight));
+		wy = _mm_add_ps(wy, _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, m10), _mm_mul_ps(vy, m11)), worldY), weight));
+	}
+	wx = _mm_add_ps(wx, _mm_set1_ps(instance->x));
+	wy = _mm_add_ps(wy, _mm_set1_ps(instance->y));
+
+	/* Interleave to x, y pairs and store them in place when the 4 vertices are adjacent in the output. */
+	low = _mm_unpacklo_ps(wx, wy);
+	high = _mm_unpackhi_ps(wx, wy);
+	if (outputs[3] == outputs[0] + 6) {
+		_mm_storeu_ps(worldVertices + outputs[0], low);
+		_mm_storeu_ps(worldVertices + outputs[0] + 4, high);
+	} else {
+		float pairs[LANES * 2];
+		int i;
+		_mm_storeu_ps(pairs, low);
+		_mm_storeu_ps(pairs + 4, high);
+		for (i = 0; i < LANES; ++i) {
+			if (outputs[i] < 0) break;
+			worldVertices[outputs[i]] = pairs[i * 2];
+			worldVertices[outputs[i] + 1] = pairs[i * 2 + 1];
+		}
+	}
+}
+
+#else
+
+static void skinBlock (const _spSkinningGroup* group, int vertex, const spSkinningInstance* instance) {
+	const float* palette = instance->palette->transforms;
+	const float* ffd = instance->ffd;
+	int i, k;
+	for (i = 0; i < LANES; ++i) {
+		int output = group->outputs[vertex + i];
+		float wx = 0, wy = 0;
+		if (output < 0) break;
+		for (k = 0; k < group->influencesCount; ++k) {
+			int index = k * group->verticesCount + vertex + i;
+			const float* transform = palette + group->transforms[index];
+			float vx = group->x[index], vy = group->y[index], weight = group->weights[index];
+			if (ffd) {
+				vx += ffd[group->ffdOffsets[vertex + i] + k * 2];
+				vy += ffd[group->ffdOffsets[vertex + i] + k * 2 + 1];
+			}
+			wx += (vx * transform[0] + vy * transform[1] + transform[4]) * weight;
+			wy += (vx * transform[2] + vy * transform[3] + transform[5]) * weight;
+		}
+		instance->worldVertices[output] = wx + instance->x;
+		instance->worldVertices[output + 1] = wy + instance->y;
+	}
+}
+
+#endif
+
+void spSkinningMesh_computeWorldVertices (const spSkinningMesh* self, const spSkinningPalette* palette, float x, float y,
+		const float* ffd, float* worldVertices) {
+	spSkinningInstance instance;
+	instance.palette = palette;
+	instance.x = x;
+	instance.y = y;
+	instance.ffd = ffd;
+	instance.worldVertices = worldVertices;
+	spSkinningMesh_computeBatch(self, &instance, 1);
+}
+
+void spSkinningMesh_computeBatch (const spSkinningMesh* self, const spSkinningInstance* instances, int instancesCount) {
+	const _spSkinningMesh* internal = SUB_CAST(_spSkinningMesh, self);
+	int g, i, start, vertex;
+	for (g = 0; g < internal->groupsCount; ++g) {
+		const _spSkinningGroup* group = internal->groups + g;
+		for (start = 0; start < group->verticesCount; start += CHUNK_BLOCKS * LANES) {
+			int end = MIN(start + CHUNK_BLOCKS * LANES, group->verticesCount);
+			for (i = 0; i < instancesCount; ++i)
+				for (vertex = start; vertex < end; vertex += LANES)
+					skinBlock(group, vertex, instances + i);
+		}
+	}
+}
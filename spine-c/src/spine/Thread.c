@@ -0,0 +1,186 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L /* sysconf */
+#endif
+
+#include <spine/Thread.h>
+#include <stdlib.h>
+
+#if defined(_WIN32)
+
+#include <windows.h>
+
+struct _spThread {
+	HANDLE handle;
+	void (*run) (void* userData);
+	void* userData;
+};
+
+struct _spMutex {
+	SRWLOCK lock;
+};
+
+struct _spCondition {
+	CONDITION_VARIABLE variable;
+};
+
+static DWORD WINAPI runThread (LPVOID parameter) {
+	_spThread* self = (_spThread*)parameter;
+	self->run(self->userData);
+	return 0;
+}
+
+_spThread* _spThread_create (void (*run) (void* userData), void* userData) {
+	_spThread* self = (_spThread*)malloc(sizeof(_spThread));
+	if (!self) return 0;
+	self->run = run;
+	self->userData = userData;
+	self->handle = CreateThread(0, 0, runThread, self, 0, 0);
+	if (!self->handle) {
+		free(self);
+		return 0;
+	}
+	return self;
+}
+
+void _spThread_join (_spThread* self) {
+	WaitForSingleObject(self->handle, INFINITE);
+	CloseHandle(self->handle);
+	free(self);
+}
+
+int _spThread_getProcessorsCount () {
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+}
+
+_spMutex* _spMutex_create () {
+	_spMutex* self = (_spMutex*)malloc(sizeof(_spMutex));
+	InitializeSRWLock(&self->lock);
+	return self;
+}
+
+void _spMutex_dispose (_spMutex* self) {
+	free(self);
+}
+
+void _spMutex_lock (_spMutex* self) {
+	AcquireSRWLockExclusive(&self->lock);
+}
+
+void _spMutex_unlock (_spMutex* self) {
+	ReleaseSRWLockExclusive(&self->lock);
+}
+
+_spCondition* _spCondition_create () {
+	_spCondition* self = (_spCondition*)malloc(sizeof(_spCondition));
+	InitializeConditionVariable(&self->variable);
+	return self;
+}
+
+void _spCondition_dispose (_spCondition* self) {
+	free(self);
+}
+
+void _spCondition_wait (_spCondition* self, _spMutex* mutex) {
+	SleepConditionVariableSRW(&self->variable, &mutex->lock, INFINITE, 0);
+}
+
+void _spCondition_signal (_spCondition* self) {
+	WakeConditionVariable(&self->variable);
+}
+
+void _spCondition_broadcast (_spCondition* self) {
+	WakeAllConditionVariable(&self->variable);
+}
+
+#else
+
+#include <pthread.h>
+#include <unistd.h>
+
+struct _spThread {
+	pthread_t thread;
+	void (*run) (void* userData);
+	void* userData;
+};
+
+struct _spMutex {
+	pthread_mutex_t mutex;
+};
+
+struct _spCondition {
+	pthread_cond_t condition;
+};
+
+static void* runThread (void* parameter) {
+	_spThread* self = (_spThread*)parameter;
+	self->run(self->userData);
+	return 0;
+}
+
+_spThread* _spThread_create (void (*run) (void* userData), void* userData) {
+	_spThread* self = (_spThread*)malloc(sizeof(_spThread));
+	if (!self) return 0;
+	self->run = run;
+	self->userData = userData;
+	if (pthread_create(&self->thread, 0, runThread, self) != 0) {
+		free(self);
+		return 0;
+	}
+	return self;
+}
+
+void _spThread_join (_spThread* self) {
+	pthread_join(self->thread, 0);
+	free(self);
+}
+
+int _spThread_getProcessorsCount () {
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 0 ? (int)count : 1;
+}
+
+_spMutex* _spMutex_create () {
+	_spMutex* self = (_spMutex*)malloc(sizeof(_spMutex));
+	pthread_mutex_init(&self->mutex, 0);
+	return self;
+}
+
+void _spMutex_dispose (_spMutex* self) {
+	pthread_mutex_destroy(&self->mutex);
+	free(self);
+}
+
+void _spMutex_lock (_spMutex* self) {
+	pthread_mutex_lock(&self->mutex);
+}
+
+void _spMutex_unlock (_spMutex* self) {
+	pthread_mutex_unlock(&self->mutex);
+}
+
+_spCondition* _spCondition_create () {
+	_spCondition* self = (_spCondition*)malloc(sizeof(_spCondition));
+	pthread_cond_init(&self->condition, 0);
+	return self;
+}
+
+void _spCondition_dispose (_spCondition* self) {
+	pthread_cond_destroy(&self->condition);
+	free(self);
+}
+
+void _spCondition_wait (_spCondition* self, _spMutex* mutex) {
+	pthread_cond_wait(&self->condition, &mutex->mutex);
+}
+
+void _spCondition_signal (_spCondition* self) {
+	pthread_cond_signal(&self->condition);
+}
+
+void _spCondition_broadcast (_spCondition* self) {
+	pthread_cond_broadcast(&self->condition);
+}
+
+#endif
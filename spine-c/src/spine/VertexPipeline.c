@@ -0,0 +1,360 @@
+#include <spine/VertexPipeline.h>
+#include <spine/RegionAttachment.h>
+#include <spine/MeshAttachment.h>
+#include <spine/SkinnedMeshAttachment.h>
+#include <spine/Thread.h>
+#include <spine/extension.h>
+
+/* Floats of world vertices per job. 512 vertices write 4KB, and read 32KB of weights and bones with 4 bones per vertex. */
+#define CHUNK_FLOATS 1024
+
+/* The world vertices of an attachment, or of a range of them for large meshes. */
+typedef struct {
+	const spSkeleton* skeleton;
+	const spSlot* slot;
+	int offset; /* Of the attachment's world vertices in the vertex buffer. */
+	int start, end; /* Range of the attachment's world vertices. */
+	int bone, weight; /* Skinned meshes: index in bones and in weights of the first vertex of the range. */
+} _spVertexItem;
+
+/* Where a skinned mesh is cut, which takes a walk over its bones to find. */
+typedef struct {
+	const spSkinnedMeshAttachment* attachment;
+	int* starts; /* Per range, the indices in bones and in weights of its first vertex. */
+} _spSkinnedCuts;
+
+typedef struct {
+	spVertexPipeline super;
+	_spThread** threads;
+	_spMutex* mutex; /* Guards the 4 fields below it and jobsCount. */
+	_spCondition* workQueued;
+	_spCondition* workDone;
+	float* vertices;
+	int nextBatch, pendingBatches;
+	int /*bool*/ stopping;
+
+	int* offsets; /* Per slot of every skeleton. */
+	int* skeletonOffsets; /* Index of each skeleton's first slot in offsets. */
+	int offsetsCapacity, skeletonsCapacity;
+	_spVertexItem* items;
+	int itemsCount, itemsCapacity;
+	int* batchEnds; /* Each job runs the items from the previous job's end to its own. */
+	int batchesCapacity;
+
+	_spSkinnedCuts* cuts; /* Open addressing on the attachment address. */
+	int cutsCount, cutsCapacity;
+} _spVertexPipeline;
+
+/* The pipeline's memory comes from the default context, whatever is current on the calling thread. */
+#define ENTER_DEFAULT_CONTEXT() const spAllocator* previous = spAllocator_setCurrent(0)
+#define LEAVE_DEFAULT_CONTEXT() spAllocator_setCurrent(previous)
+
+/**/
+
+static void computeItem (const _spVertexItem* item, float* vertices) {
+	const spSlot* slot = item->slot;
+	const spBone* bone = slot->bone;
+	float x = item->skeleton->x, y = item->skeleton->y;
+	float* worldVertices = vertices + item->offset;
+	int i;
+
+	switch (slot->attachment->type) {
+	case SP_ATTACHMENT_REGION:
+		spRegionAttachment_computeWorldVertices(SUB_CAST(spRegionAttachment, slot->attachment), x, y, slot->bone, worldVertices);
+		break;
+	case SP_ATTACHMENT_MESH: {
+		const spMeshAttachment* mesh = SUB_CAST(spMeshAttachment, slot->attachment);
+		const float* meshVertices = mesh->vertices;
+		if (slot->attachmentVerticesCount == mesh->verticesCount) meshVertices = slot->attachmentVertices;
+		x += bone->worldX;
+		y += bone->worldY;
+		for (i = item->start; i < item->end; i += 2) {
+			const float vx = meshVertices[i], vy = meshVertices[i + 1];
+			worldVertices[i] = vx * bone->m00 + vy * bone->m01 + x;
+			worldVertices[i + 1] = vx * bone->m10 + vy * bone->m11 + y;
+		}
+		break;
+	}
+	case SP_ATTACHMENT_SKINNED_MESH: {
+		const spSkinnedMeshAttachment* mesh = SUB_CAST(spSkinnedMeshAttachment, slot->attachment);
+		spBone** skeletonBones = item->skeleton->bones;
+		int v = item->bone, b = item->weight, f = item->weight / 3 * 2;
+		if (slot->attachmentVerticesCount == 0) {
+			for (i = item->start; i < item->end; i += 2) {
+				const int nn = mesh->bones[v] + v;
+				float wx = 0, wy = 0;
+				v++;
+				for (; v <= nn; v++, b += 3) {
+					const spBone* skinBone = skeletonBones[mesh->bones[v]];
+					const float vx = mesh->weights[b], vy = mesh->weights[b + 1], weight = mesh->weights[b + 2];
+					wx += (vx * skinBone->m00 + vy * skinBone->m01 + skinBone->worldX) * weight;
+					wy += (vx * skinBone->m10 + vy * skinBone->m11 + skinBone->worldY) * weight;
+				}
+				worldVertices[i] = wx + x;
+				worldVertices[i + 1] = wy + y;
+			}
+		} else {
+			const float* ffd = slot->attachmentVertices;
+			for (i = item->start; i < item->end; i += 2) {
+				const int nn = mesh->bones[v] + v;
+				float wx = 0, wy = 0;
+				v++;
+				for (; v <= nn; v++, b += 3, f += 2) {
+					const spBone* skinBone = skeletonBones[mesh->bones[v]];
+					const float vx = mesh->weights[b] + ffd[f], vy = mesh->weights[b + 1] + ffd[f + 1];
+					const float weight = mesh->weights[b + 2];
+					wx += (vx * skinBone->m00 + vy * skinBone->m01 + skinBone->worldX) * weight;
+					wy += (vx * skinBone->m10 + vy * skinBone->m11 + skinBone->worldY) * weight;
+				}
+				worldVertices[i] = wx + x;
+				worldVertices[i + 1] = wy + y;
+			}
+		}
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+/* Claims and runs jobs until none are left, with the lock held on entry and exit. */
+static void runBatches (_spVertexPipeline* self) {
+	while (self->nextBatch < self->super.jobsCount) {
+		int batch = self->nextBatch++, i, end = self->batchEnds[batch];
+		_spMutex_unlock(self->mutex);
+		for (i = batch ? self->batchEnds[batch - 1] : 0; i < end; ++i)
+			computeItem(self->items + i, self->vertices);
+		_spMutex_lock(self->mutex);
+		if (--self->pendingBatches == 0) _spCondition_broadcast(self->workDone);
+	}
+}
+
+static void runWorker (void* userData) {
+	_spVertexPipeline* self = (_spVertexPipeline*)userData;
+	_spMutex_lock(self->mutex);
+	for (;;) {
+		while (self->nextBatch >= self->super.jobsCount && !self->stopping)
+			_spCondition_wait(self->workQueued, self->mutex);
+		if (self->stopping) break;
+		runBatches(self);
+	}
+	_spMutex_unlock(self->mutex);
+}
+
+/**/
+
+static unsigned int hashAttachment (const spSkinnedMeshAttachment* attachment) {
+	return (unsigned int)((size_t)attachment >> 4) * 2654435761u;
+}
+
+static void addCuts (_spVertexPipeline* self, _spSkinnedCuts cuts) {
+	unsigned int mask = (unsigned int)self->cutsCapacity - 1, i = hashAttachment(cuts.attachment) & mask;
+	while (self->cuts[i].attachment)
+		i = (i + 1) & mask;
+	self->cuts[i] = cuts;
+	self->cutsCount++;
+}
+
+static const int* getCuts (_spVertexPipeline* self, const spSkinnedMeshAttachment* attachment) {
+	_spSkinnedCuts cuts;
+	int v, b, i;
+	if (self->cutsCapacity) {
+		unsigned int mask = (unsigned int)self->cutsCapacity - 1, index = hashAttachment(attachment) & mask;
+		for (; self->cuts[index].attachment; index = (index + 1) & mask)
+			if (self->cuts[index].attachment == attachment) return self->cuts[index].starts;
+	}
+
+	if ((self->cutsCount + 1) * 4 > self->cutsCapacity * 3) {
+		_spSkinnedCuts* old = self->cuts;
+		int oldCapacity = self->cutsCapacity;
+		self->cutsCapacity = oldCapacity ? oldCapacity * 2 : 16;
+		self->cuts = CALLOC(_spSkinnedCuts, self->cutsCapacity);
+		self->cutsCount = 0;
+		for (i = 0; i < oldCapacity; ++i)
+			if (old[i].attachment) addCuts(self, old[i]);
+		FREE(old);
+	}
+
+	cuts.attachment = attachment;
+	cuts.starts = MALLOC(int, (attachment->uvsCount + CHUNK_FLOATS - 1) / CHUNK_FLOATS * 2 + 2);
+	for (v = 0, b = 0, i = 0; v < attachment->bonesCount && i < attachment->uvsCount; i += 2) {
+		if (i % CHUNK_FLOATS == 0) {
+			cuts.starts[i / CHUNK_FLOATS * 2] = v;
+			cuts.starts[i / CHUNK_FLOATS * 2 + 1] = b;
+		}
+		b += attachment->bones[v] * 3;
+		v += attachment->bones[v] + 1;
+	}
+	addCuts(self, cuts);
+	return cuts.starts;
+}
+
+/**/
+
+spVertexPipeline* spVertexPipeline_create (int threadsCount) {
+	_spVertexPipeline* self;
+	int i;
+	ENTER_DEFAULT_CONTEXT();
+
+	if (threadsCount <= 0) threadsCount = _spThread_getProcessorsCount() - 1;
+	self = NEW(_spVertexPipeline);
+	self->mutex = _spMutex_create();
+	self->workQueued = _spCondition_create();
+	self->workDone = _spCondition_create();
+	self->threads = MALLOC(_spThread*, threadsCount > 0 ? threadsCount : 1);
+	for (i = 0; i < threadsCount; ++i) {
+		_spThread* thread = _spThread_create(runWorker, self);
+		if (!thread) break;
+		self->threads[CONST_CAST(int, self->super.threadsCount)++] = thread;
+	}
+
+	LEAVE_DEFAULT_CONTEXT();
+	return SUPER(self);
+}
+
+void spVertexPipeline_dispose (spVertexPipeline* self) {
+	_spVertexPipeline* internal = SUB_CAST(_spVertexPipeline, self);
+	int i;
+	ENTER_DEFAULT_CONTEXT();
+
+	_spMutex_lock(internal->mutex);
+	internal->stopping = 1;
+	_spCondition_broadcast(internal->workQueued);
+	_spMutex_unlock(internal->mutex);
+	for (i = 0; i < self->threadsCount; ++i)
+		_spThread_join(internal->threads[i]);
+
+	spVertexPipeline_clearCache(self);
+	_spCondition_dispose(internal->workDone);
+	_spCondition_dispose(internal->workQueued);
+	_spMutex_dispose(internal->mutex);
+	FREE(internal->threads);
+	FREE(internal->offsets);
+	FREE(internal->skeletonOffsets);
+	FREE(internal->items);
+	FREE(internal->batchEnds);
+	FREE(internal);
+	LEAVE_DEFAULT_CONTEXT();
+}
+
+static _spVertexItem* addItem (_spVertexPipeline* self) {
+	if (self->itemsCount == self->itemsCapacity) {
+		self->itemsCapacity = MAX(self->itemsCapacity * 2, 64);
+		self->items = REALLOC(self->items, _spVertexItem, self->itemsCapacity);
+	}
+	return self->items + self->itemsCount++;
+}
+
+int spVertexPipeline_layout (spVertexPipeline* self, spSkeleton* const* skeletons, int skeletonsCount) {
+	_spVertexPipeline* internal = SUB_CAST(_spVertexPipeline, self);
+	int slotsCount = 0, verticesCount = 0, batchesCount = 0, batchFloats = 0, s, i;
+	ENTER_DEFAULT_CONTEXT();
+
+	for (s = 0; s < skeletonsCount; ++s)
+		slotsCount += skeletons[s]->slotsCount;
+	if (slotsCount > internal->offsetsCapacity) {
+		FREE(internal->offsets);
+		internal->offsetsCapacity = slotsCount;
+		internal->offsets = MALLOC(int, slotsCount);
+	}
+	if (skeletonsCount > internal->skeletonsCapacity) {
+		FREE(internal->skeletonOffsets);
+		internal->skeletonsCapacity = skeletonsCount;
+		internal->skeletonOffsets = MALLOC(int, skeletonsCount);
+	}
+
+	internal->itemsCount = 0;
+	for (s = 0, slotsCount = 0; s < skeletonsCount; ++s) {
+		const spSkeleton* skeleton = skeletons[s];
+		internal->skeletonOffsets[s] = slotsCount;
+		for (i = 0; i < skeleton->slotsCount; ++i) {
+			const spSlot* slot = skeleton->slots[i];
+			const int* cuts = 0;
+			int count, start;
+			internal->offsets[slotsCount + i] = -1;
+			if (!slot->attachment) continue;
+			switch (slot->attachment->type) {
+			case SP_ATTACHMENT_REGION:
+				count = 8;
+				break;
+			case SP_ATTACHMENT_MESH:
+				count = SUB_CAST(spMeshAttachment, slot->attachment)->verticesCount;
+				break;
+			case SP_ATTACHMENT_SKINNED_MESH:
+				count = SUB_CAST(spSkinnedMeshAttachment, slot->attachment)->uvsCount;
+				if (count > CHUNK_FLOATS) cuts = getCuts(internal, SUB_CAST(spSkinnedMeshAttachment, slot->attachment));
+				break;
+			default:
+				continue;
+			}
+			internal->offsets[slotsCount + i] = verticesCount;
+			for (start = 0; start < count; start += CHUNK_FLOATS) {
+				_spVertexItem* item = addItem(internal);
+				item->skeleton = skeleton;
+				item->slot = slot;
+				item->offset = verticesCount;
+				item->start = start;
+				item->end = MIN(start + CHUNK_FLOATS, count);
+				item->bone = cuts ? cuts[start / CHUNK_FLOATS * 2] : 0;
+				item->weight = cuts ? cuts[start / CHUNK_FLOATS * 2 + 1] : 0;
+			}
+			verticesCount += count;
+		}
+		slotsCount += skeleton->slotsCount;
+	}
+
+	/* Small items are grouped until a job has about CHUNK_FLOATS of world vertices. */
+	if (internal->itemsCount > internal->batchesCapacity) {
+		FREE(internal->batchEnds);
+		internal->batchesCapacity = internal->itemsCapacity;
+		internal->batchEnds = MALLOC(int, internal->batchesCapacity);
+	}
+	for (i = 0; i < internal->itemsCount; ++i) {
+		batchFloats += internal->items[i].end - internal->items[i].start;
+		if (batchFloats >= CHUNK_FLOATS || i == internal->itemsCount - 1) {
+			internal->batchEnds[batchesCount++] = i + 1;
+			batchFloats = 0;
+		}
+	}
+
+	/* No job is claimable until spVertexPipeline_compute resets nextBatch. */
+	_spMutex_lock(internal->mutex);
+	CONST_CAST(int, self->jobsCount) = batchesCount;
+	internal->nextBatch = batchesCount;
+	_spMutex_unlock(internal->mutex);
+	CONST_CAST(int, self->skeletonsCount) = skeletonsCount;
+	CONST_CAST(int, self->verticesCount) = verticesCount;
+	LEAVE_DEFAULT_CONTEXT();
+	return verticesCount;
+}
+
+const int* spVertexPipeline_getOffsets (const spVertexPipeline* self, int skeletonIndex) {
+	const _spVertexPipeline* internal = SUB_CAST(_spVertexPipeline, self);
+	return internal->offsets + internal->skeletonOffsets[skeletonIndex];
+}
+
+void spVertexPipeline_compute (spVertexPipeline* self, float* vertices) {
+	_spVertexPipeline* internal = SUB_CAST(_spVertexPipeline, self);
+	_spMutex_lock(internal->mutex);
+	internal->vertices = vertices;
+	internal->nextBatch = 0;
+	internal->pendingBatches = self->jobsCount;
+	_spCondition_broadcast(internal->workQueued);
+	runBatches(internal);
+	while (internal->pendingBatches > 0)
+		_spCondition_wait(internal->workDone, internal->mutex);
+	_spMutex_unlock(internal->mutex);
+}
+
+void spVertexPipeline_clearCache (spVertexPipeline* self) {
+	_spVertexPipeline* internal = SUB_CAST(_spVertexPipeline, self);
+	int i;
+	ENTER_DEFAULT_CONTEXT();
+	for (i = 0; i < internal->cutsCapacity; ++i)
+		FREE(internal->cuts[i].starts);
+	FREE(internal->cuts);
+	internal->cuts = 0;
+	internal->cutsCount = 0;
+	internal->cutsCapacity = 0;
+	LEAVE_DEFAULT_CONTEXT();
+}
@@ -28,6 +28,10 @@
  * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  *****************************************************************************/
 
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L /* posix_memalign */
+#endif
+
 #include <spine/extension.h>
 #include <stdio.h>
 
@@ -35,26 +39,379 @@ static void* (*mallocFunc)(size_t size) = malloc;
 static void* (*reallocFunc)(void* ptr, size_t size) = realloc;
 static void* (*debugMallocFunc)(size_t size, const char* file, int line) = NULL;
 static void (*freeFunc)(void* ptr) = free;
+static void* (*mallocAlignedFunc)(size_t size, size_t alignment) = NULL;
+static void (*freeSizedFunc)(void* ptr, size_t size) = NULL;
+
+static SP_THREAD_LOCAL const spAllocator* currentAllocator;
+
+#ifdef SPINE_BINARY_PROFILE
+static SP_THREAD_LOCAL size_t threadAllocations, threadAllocatedBytes;
+#define COUNT_ALLOCATION(SIZE) (++threadAllocations, threadAllocatedBytes += (SIZE))
+#else
+#define COUNT_ALLOCATION(SIZE)
+#endif
+
+/* Route to the current allocator context, or to the hooks above when there is none. */
+static void* allocate (size_t size, const char* file, int line) {
+	const spAllocator* allocator = currentAllocator;
+	COUNT_ALLOCATION(size);
+	if (allocator) return allocator->allocate(allocator->userData, size, file, line);
+	return debugMallocFunc ? debugMallocFunc(size, file, line) : mallocFunc(size);
+}
+
+static void* reallocate (void* ptr, size_t size) {
+	const spAllocator* allocator = currentAllocator;
+	COUNT_ALLOCATION(size);
+	if (allocator) return allocator->reallocate(allocator->userData, ptr, size);
+	return reallocFunc(ptr, size);
+}
+
+/* A dispose-only context has no deallocate, its memory is given back when the context is. */
+static void deallocate (void* ptr) {
+	const spAllocator* allocator = currentAllocator;
+	if (allocator) {
+		if (allocator->deallocate) allocator->deallocate(allocator->userData, ptr);
+	} else
+		freeFunc(ptr);
+}
+
+#ifdef SPINE_MEMORY_STATS
+
+/* Each block is prefixed by a header holding its size and call site. 16 bytes keeps the block malloc aligned. */
+#define HEADER_SIZE 16
+#define MAX_SITES 4096
+
+typedef struct {
+	size_t size;
+	int site;
+	int offset; /* Bytes between the allocated block and the header, non-zero only for over-aligned blocks. */
+} _spMemoryHeader;
+
+static spMemorySiteStats sites[MAX_SITES];
+static int sitesCount;
+static spMemoryStats subsystemStats[SP_MEMORY_SUBSYSTEMS_COUNT];
+static spMemoryStats totalStats;
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+static volatile long statsLock;
+#define LOCK_STATS() while (_InterlockedExchange(&statsLock, 1)) {}
+#define UNLOCK_STATS() _InterlockedExchange(&statsLock, 0)
+#else
+static volatile int statsLock;
+#define LOCK_STATS() while (__sync_lock_test_and_set(&statsLock, 1)) {}
+#define UNLOCK_STATS() __sync_lock_release(&statsLock)
+#endif
+
+static spMemorySubsystem getSubsystem (const char* file) {
+	static const struct {
+		const char* name;
+		spMemorySubsystem subsystem;
+	} files[] = {
+		{"SkeletonBinary.c", SP_MEMORY_LOADER}, {"SkeletonJson.c", SP_MEMORY_LOADER}, {"Json.c", SP_MEMORY_LOADER},
+		{"Atlas.c", SP_MEMORY_LOADER}, {"AtlasAttachmentLoader.c", SP_MEMORY_LOADER}, {"AttachmentLoader.c", SP_MEMORY_LOADER},
+		{"Skin.c", SP_MEMORY_LOADER}, {"Attachment.c", SP_MEMORY_LOADER}, {"RegionAttachment.c", SP_MEMORY_LOADER},
+		{"MeshAttachment.c", SP_MEMORY_LOADER}, {"SkinnedMeshAttachment.c", SP_MEMORY_LOADER},
+		{"BoundingBoxAttachment.c", SP_MEMORY_LOADER}, {"SkeletonData.c", SP_MEMORY_LOADER}, {"BoneData.c", SP_MEMORY_LOADER},
+		{"SlotData.c", SP_MEMORY_LOADER}, {"IkConstraintData.c", SP_MEMORY_LOADER}, {"EventData.c", SP_MEMORY_LOADER},
+		{"Bone.c", SP_MEMORY_BONES}, {"Slot.c", SP_MEMORY_BONES}, {"Skeleton.c", SP_MEMORY_BONES},
+		{"IkConstraint.c", SP_MEMORY_BONES}, {"SkeletonBounds.c", SP_MEMORY_BONES},
+		{"Animation.c", SP_MEMORY_TIMELINES}, {"AnimationState.c", SP_MEMORY_TIMELINES},
+		{"AnimationStateData.c", SP_MEMORY_TIMELINES}, {"Event.c", SP_MEMORY_TIMELINES},
+		{"Array.c", SP_MEMORY_ARRAYS}
+	};
+	const char* name;
+	int i;
+	if (!file) return SP_MEMORY_OTHER;
+	name = file + strlen(file);
+	while (name > file && name[-1] != '/' && name[-1] != '\\') --name;
+	for (i = 0; i < (int)(sizeof(files) / sizeof(files[0])); ++i)
+		if (strcmp(name, files[i].name) == 0) return files[i].subsystem;
+	return SP_MEMORY_OTHER;
+}
+
+/* Must be called with the lock held. Sites are found through an open addressing table keyed on the __FILE__ pointer and
+ * line. The last site collects everything once the table is full. */
+static int findSite (const char* file, int line) {
+	static int siteSlots[MAX_SITES * 2]; /* Site index + 1, 0 when empty. */
+	unsigned int mask = MAX_SITES * 2 - 1;
+	unsigned int i = ((unsigned int)((size_t)file >> 3) * 31u + (unsigned int)line) * 2654435761u;
+	for (i &= mask;; i = (i + 1) & mask) {
+		int site = siteSlots[i] - 1;
+		if (site < 0) break;
+		if (sites[site].line == line && sites[site].file == file) return site;
+	}
+	if (sitesCount == MAX_SITES) return MAX_SITES - 1;
+	siteSlots[i] = sitesCount + 1;
+	sites[sitesCount].file = file;
+	sites[sitesCount].line = line;
+	sites[sitesCount].subsystem = getSubsystem(file);
+	return sitesCount++;
+}
+
+static void addLive (spMemoryStats* stats, size_t size) {
+	stats->liveBytes += size;
+	if (stats->liveBytes > stats->peakBytes) stats->peakBytes = stats->liveBytes;
+}
+
+static void recordAlloc (_spMemoryHeader* header, size_t size, const char* file, int line) {
+	spMemorySiteStats* site;
+	LOCK_STATS();
+	header->size = size;
+	header->site = findSite(file, line);
+	site = sites + header->site;
+	site->stats.allocations++;
+	addLive(&site->stats, size);
+	subsystemStats[site->subsystem].allocations++;
+	addLive(&subsystemStats[site->subsystem], size);
+	totalStats.allocations++;
+	addLive(&totalStats, size);
+	UNLOCK_STATS();
+}
+
+static void recordFree (_spMemoryHeader* header) {
+	spMemorySiteStats* site;
+	LOCK_STATS();
+	site = sites + header->site;
+	site->stats.frees++;
+	site->stats.liveBytes -= header->size;
+	subsystemStats[site->subsystem].frees++;
+	subsystemStats[site->subsystem].liveBytes -= header->size;
+	totalStats.frees++;
+	totalStats.liveBytes -= header->size;
+	UNLOCK_STATS();
+}
+
+static void recordRealloc (_spMemoryHeader* header, size_t oldSize, size_t size) {
+	spMemorySiteStats* site;
+	LOCK_STATS();
+	site = sites + header->site;
+	header->size = size;
+	site->stats.reallocations++;
+	site->stats.liveBytes -= oldSize;
+	addLive(&site->stats, size);
+	subsystemStats[site->subsystem].reallocations++;
+	subsystemStats[site->subsystem].liveBytes -= oldSize;
+	addLive(&subsystemStats[site->subsystem], size);
+	totalStats.reallocations++;
+	totalStats.liveBytes -= oldSize;
+	addLive(&totalStats, size);
+	UNLOCK_STATS();
+}
 
 void* _spMalloc(size_t size, const char* file, int line) {
-	if (debugMallocFunc)
-		return debugMallocFunc(size, file, line);
+	char* block = allocate(size + HEADER_SIZE, file, line);
+	if (!block) return 0;
+	recordAlloc((_spMemoryHeader*)block, size, file, line);
+	((_spMemoryHeader*)block)->offset = 0;
+	return block + HEADER_SIZE;
+}
 
-	return mallocFunc(size);
+/* The header is placed right before the aligned payload, offset records where the allocated block starts. */
+void* _spMallocAligned(size_t size, size_t alignment, const char* file, int line) {
+	char *block, *header;
+	if (alignment <= HEADER_SIZE) return _spMalloc(size, file, line);
+	if (mallocAlignedFunc && !currentAllocator) {
+		block = mallocAlignedFunc(size + alignment, alignment);
+		if (!block) return 0;
+		header = block + alignment - HEADER_SIZE;
+	} else {
+		block = allocate(size + alignment + HEADER_SIZE, file, line);
+		if (!block) return 0;
+		/* Rounds down so offset is never 0, which marks blocks allocated without padding. */
+		header = (char*)(((size_t)block + HEADER_SIZE + alignment) & ~(alignment - 1)) - HEADER_SIZE;
+	}
+	recordAlloc((_spMemoryHeader*)header, size, file, line);
+	((_spMemoryHeader*)header)->offset = (int)(header - block);
+	return header + HEADER_SIZE;
 }
 
-void* _spCalloc(size_t num, size_t size, const char* file, int line) {
-	void* ptr = _spMalloc(num * size, file, line);
-	if (ptr) memset(ptr, 0, num * size);
-	return ptr;
+/* An over-aligned block keeps its header offset when moved, the payload is then only as aligned as realloc makes it. */
+void* _spRealloc(void* ptr, size_t size) {
+	char* block;
+	size_t oldSize;
+	int offset;
+	if (!ptr) return _spMalloc(size, 0, 0);
+	block = (char*)ptr - HEADER_SIZE;
+	oldSize = ((_spMemoryHeader*)block)->size;
+	offset = ((_spMemoryHeader*)block)->offset;
+	block = reallocate(block - offset, size + HEADER_SIZE + offset);
+	if (!block) return 0;
+	block += offset;
+	recordRealloc((_spMemoryHeader*)block, oldSize, size);
+	return block + HEADER_SIZE;
+}
+
+void _spFree(void* ptr) {
+	char* block;
+	if (!ptr) return;
+	block = (char*)ptr - HEADER_SIZE;
+	recordFree((_spMemoryHeader*)block);
+	deallocate(block - ((_spMemoryHeader*)block)->offset);
+}
+
+/* Over-aligned blocks were allocated with padding, so their size is not known to the hook and they use the plain free. */
+void _spFreeSized(void* ptr, size_t size) {
+	_spMemoryHeader* header;
+	if (!ptr) return;
+	header = (_spMemoryHeader*)((char*)ptr - HEADER_SIZE);
+	recordFree(header);
+	if (freeSizedFunc && !currentAllocator && !header->offset)
+		freeSizedFunc(header, size + HEADER_SIZE);
+	else
+		deallocate((char*)header - header->offset);
+}
+
+int _spMemoryStats_get(spMemoryStats* total, spMemoryStats* subsystems) {
+	LOCK_STATS();
+	if (total) *total = totalStats;
+	if (subsystems) memcpy(subsystems, subsystemStats, sizeof(subsystemStats));
+	UNLOCK_STATS();
+	return 1;
+}
+
+int _spMemoryStats_getSites(spMemorySiteStats* out, int capacity) {
+	int count;
+	LOCK_STATS();
+	count = sitesCount;
+	memcpy(out, sites, sizeof(spMemorySiteStats) * MIN(capacity, count));
+	UNLOCK_STATS();
+	return count;
+}
+
+static void resetStats (spMemoryStats* stats) {
+	stats->peakBytes = stats->liveBytes;
+	stats->allocations = 0;
+	stats->reallocations = 0;
+	stats->frees = 0;
+}
+
+void _spMemoryStats_reset() {
+	int i;
+	LOCK_STATS();
+	for (i = 0; i < sitesCount; ++i)
+		resetStats(&sites[i].stats);
+	for (i = 0; i < SP_MEMORY_SUBSYSTEMS_COUNT; ++i)
+		resetStats(&subsystemStats[i]);
+	resetStats(&totalStats);
+	UNLOCK_STATS();
+}
+
+static int compareSites (const void* a, const void* b) {
+	size_t liveA = ((const spMemorySiteStats*)a)->stats.liveBytes, liveB = ((const spMemorySiteStats*)b)->stats.liveBytes;
+	return liveA < liveB ? 1 : liveA > liveB ? -1 : 0;
+}
+
+static void reportLine (FILE* file, const char* kind, const char* name, int line, const spMemoryStats* stats) {
+	fprintf(file, "%s\t%s\t%d\t%lu\t%lu\t%lu\t%lu\t%lu\n", kind, name, line, (unsigned long)stats->liveBytes,
+			(unsigned long)stats->peakBytes, (unsigned long)stats->allocations, (unsigned long)stats->reallocations,
+			(unsigned long)stats->frees);
+}
+
+void _spMemoryStats_report(FILE* file) {
+	static const char* subsystemNames[SP_MEMORY_SUBSYSTEMS_COUNT] = {"loader", "bones", "timelines", "arrays", "other"};
+	spMemoryStats total, subsystems[SP_MEMORY_SUBSYSTEMS_COUNT];
+	spMemorySiteStats* snapshot;
+	int i, count;
+
+	_spMemoryStats_get(&total, subsystems);
+	/* Snapshot with the system allocator so the report does not count itself. */
+	snapshot = (spMemorySiteStats*)malloc(sizeof(spMemorySiteStats) * MAX_SITES);
+	if (!snapshot) return;
+	count = MIN(_spMemoryStats_getSites(snapshot, MAX_SITES), MAX_SITES);
+	qsort(snapshot, count, sizeof(spMemorySiteStats), compareSites);
+
+	fprintf(file, "kind\tname\tline\tlive\tpeak\tallocations\treallocations\tfrees\n");
+	reportLine(file, "total", "-", 0, &total);
+	for (i = 0; i < SP_MEMORY_SUBSYSTEMS_COUNT; ++i)
+		reportLine(file, "subsystem", subsystemNames[i], 0, &subsystems[i]);
+	for (i = 0; i < count; ++i)
+		reportLine(file, "site", snapshot[i].file ? snapshot[i].file : "(realloc)", snapshot[i].line, &snapshot[i].stats);
+	free(snapshot);
+}
+
+#else
+
+void* _spMalloc(size_t size, const char* file, int line) {
+	return allocate(size, file, line);
 }
 
 void* _spRealloc(void* ptr, size_t size) {
-	return reallocFunc(ptr, size);
+	return reallocate(ptr, size);
 }
 
 void _spFree(void* ptr) {
-	freeFunc(ptr);
+	deallocate(ptr);
+}
+
+/* Aligned memory that free() can release. Windows has no such function, _aligned_malloc needs _aligned_free, so malloc's
+ * own alignment is used there. */
+static void* systemMallocAligned (size_t size, size_t alignment) {
+#if defined(_WIN32)
+	UNUSED(alignment);
+	return malloc(size);
+#else
+	void* ptr;
+	if (alignment < sizeof(void*)) alignment = sizeof(void*);
+	return posix_memalign(&ptr, alignment, size) ? 0 : ptr;
+#endif
+}
+
+void* _spMallocAligned(size_t size, size_t alignment, const char* file, int line) {
+	if (currentAllocator) return allocate(size, file, line);
+	if (mallocAlignedFunc) {
+		COUNT_ALLOCATION(size);
+		return mallocAlignedFunc(size, alignment);
+	}
+	if (!debugMallocFunc && mallocFunc == malloc && reallocFunc == realloc && freeFunc == free) {
+		COUNT_ALLOCATION(size);
+		return systemMallocAligned(size, alignment);
+	}
+	return _spMalloc(size, file, line);
+}
+
+void _spFreeSized(void* ptr, size_t size) {
+	if (freeSizedFunc && !currentAllocator) {
+		if (ptr) freeSizedFunc(ptr, size);
+	} else
+		deallocate(ptr);
+}
+
+int _spMemoryStats_get(spMemoryStats* total, spMemoryStats* subsystems) {
+	if (total) memset(total, 0, sizeof(spMemoryStats));
+	if (subsystems) memset(subsystems, 0, sizeof(spMemoryStats) * SP_MEMORY_SUBSYSTEMS_COUNT);
+	return 0;
+}
+
+int _spMemoryStats_getSites(spMemorySiteStats* sites, int capacity) {
+	UNUSED(sites);
+	UNUSED(capacity);
+	return 0;
+}
+
+void _spMemoryStats_reset() {
+}
+
+void _spMemoryStats_report(FILE* file) {
+	fprintf(file, "Memory statistics are disabled, build with SPINE_MEMORY_STATS.\n");
+}
+
+#endif /* SPINE_MEMORY_STATS */
+
+void* _spCalloc(size_t num, size_t size, const char* file, int line) {
+	void* ptr = _spMalloc(num * size, file, line);
+	if (ptr) memset(ptr, 0, num * size);
+	return ptr;
+}
+
+void _spAllocationCounts_get(size_t* allocations, size_t* bytes) {
+#ifdef SPINE_BINARY_PROFILE
+	*allocations = threadAllocations;
+	*bytes = threadAllocatedBytes;
+#else
+	*allocations = 0;
+	*bytes = 0;
+#endif
 }
 
 void _spSetDebugMalloc(void* (*malloc)(size_t size, const char* file, int line)) {
@@ -73,6 +430,24 @@ void _spSetFree(void (*free)(void* ptr)) {
 	freeFunc = free;
 }
 
+void _spSetMallocAligned(void* (*mallocAligned)(size_t size, size_t alignment)) {
+	mallocAlignedFunc = mallocAligned;
+}
+
+void _spSetFreeSized(void (*freeSized)(void* ptr, size_t size)) {
+	freeSizedFunc = freeSized;
+}
+
+const spAllocator* spAllocator_setCurrent (const spAllocator* allocator) {
+	const spAllocator* previous = currentAllocator;
+	currentAllocator = allocator;
+	return previous;
+}
+
+const spAllocator* spAllocator_getCurrent () {
+	return currentAllocator;
+}
+
 char* _spReadFile(const char* path, int* length) {
 	char* data;
 	size_t result;
@@ -90,3 +465,18 @@ char* _spReadFile(const char* path, int* length) {
 
 	return data;
 }
+
+int _spTimeline_binarySearch1 (const float* values, int valuesLength, float target) {
+	int low = 0, high = valuesLength - 2, current;
+	if (high == 0) return 1;
+	current = high >> 1;
+	while (1) {
+		if (values[current + 1] <= target)
+			low = current + 1;
+		else
+			high = current;
+		if (low == high) return low + 1;
+		current = (low + high) >> 1;
+	}
+	return 0;
+}